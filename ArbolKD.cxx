@@ -0,0 +1,207 @@
+#include "ArbolKD.h"
+#include <algorithm>
+#include <limits>
+
+namespace {
+
+// Compara índices de producto por una coordenada
+struct ComparaCoordenada {
+    const Coordenada* valores; // Las x o las y
+    
+    bool operator()(int a, int b) const {
+        return valores[a] < valores[b];
+    }
+};
+
+// Consulta de vecinos sin marcar: conserva los k mejores en un heap de
+// máximo con orden (clave de distancia, índice)
+struct ConsultaVecinos {
+    const std::vector<ArbolKD::Nodo>& nodos;
+    const std::vector<int>& indices;
+    const std::vector<Coordenada>& xs;
+    const std::vector<Coordenada>& ys;
+    const std::vector<char>& marcadoPos;
+    const std::vector<int>& vivosNodo;
+    
+    double x, y;
+    int k;
+    int excluir;
+    std::vector<std::pair<double, int> >& mejores;
+    
+    ConsultaVecinos(const std::vector<ArbolKD::Nodo>& n, const std::vector<int>& ind,
+                    const std::vector<Coordenada>& px, const std::vector<Coordenada>& py,
+                    const std::vector<char>& m, const std::vector<int>& v,
+                    std::vector<std::pair<double, int> >& heap)
+        : nodos(n), indices(ind), xs(px), ys(py), marcadoPos(m), vivosNodo(v),
+          x(0), y(0), k(1), excluir(-1), mejores(heap) {
+        mejores.clear();
+    }
+    
+    double cota() const {
+        return ((int)mejores.size() < k) ? std::numeric_limits<double>::infinity()
+                                         : mejores.front().first;
+    }
+    
+    void visitar(int id) {
+        if (vivosNodo[id] == 0) return;
+        const ArbolKD::Nodo& nodo = nodos[id];
+        if (ArbolKD::claveCaja(nodo, x, y) > cota()) return;
+        
+        if (nodo.izq < 0) {
+            for (int pos = nodo.ini; pos < nodo.fin; pos++) {
+                if (marcadoPos[pos] || indices[pos] == excluir) continue;
+                std::pair<double, int> candidato(Metrica::clave(xs[pos] - x, ys[pos] - y),
+                                                 indices[pos]);
+                if ((int)mejores.size() < k) {
+                    mejores.push_back(candidato);
+                    std::push_heap(mejores.begin(), mejores.end());
+                } else if (candidato < mejores.front()) {
+                    std::pop_heap(mejores.begin(), mejores.end());
+                    mejores.back() = candidato;
+                    std::push_heap(mejores.begin(), mejores.end());
+                }
+            }
+            return;
+        }
+        
+        if (ArbolKD::claveCaja(nodos[nodo.izq], x, y) <=
+            ArbolKD::claveCaja(nodos[nodo.der], x, y)) {
+            visitar(nodo.izq);
+            visitar(nodo.der);
+        } else {
+            visitar(nodo.der);
+            visitar(nodo.izq);
+        }
+    }
+};
+
+}
+
+void ArbolKD::construir(const Coordenadas& coordenadas) {
+    limpiar();
+    int n = coordenadas.size();
+    if (n == 0) return;
+    
+    indices.resize(n);
+    for (int i = 0; i < n; i++) {
+        indices[i] = i;
+    }
+    
+    // Un árbol con hojas de TAMANO_HOJA tiene menos de 2n/TAMANO_HOJA nodos
+    nodos.reserve(2 * (n / TAMANO_HOJA + 1));
+    construirNodo(coordenadas, 0, n);
+    
+    xs.resize(n);
+    ys.resize(n);
+    posDe.resize(n);
+    const Coordenada* cx = coordenadas.datosX();
+    const Coordenada* cy = coordenadas.datosY();
+    for (int pos = 0; pos < n; pos++) {
+        xs[pos] = cx[indices[pos]];
+        ys[pos] = cy[indices[pos]];
+        posDe[indices[pos]] = pos;
+    }
+    
+    marcadoPos.assign(n, 0);
+    vivosNodo.resize(nodos.size());
+    desmarcarTodos();
+}
+
+void ArbolKD::marcar(int indice) {
+    int pos = posDe[indice];
+    if (marcadoPos[pos]) return;
+    marcadoPos[pos] = 1;
+    
+    // Descender desde la raíz por los nodos cuyo rango contiene pos
+    int id = 0;
+    while (id >= 0) {
+        vivosNodo[id]--;
+        const Nodo& nodo = nodos[id];
+        if (nodo.izq < 0) break;
+        id = (pos < nodos[nodo.izq].fin) ? nodo.izq : nodo.der;
+    }
+}
+
+void ArbolKD::desmarcarTodos() {
+    std::fill(marcadoPos.begin(), marcadoPos.end(), 0);
+    for (size_t id = 0; id < nodos.size(); id++) {
+        vivosNodo[id] = nodos[id].fin - nodos[id].ini;
+    }
+}
+
+int ArbolKD::masCercano(double x, double y) const {
+    if (nodos.empty()) return -1;
+    ConsultaVecinos consulta(nodos, indices, xs, ys, marcadoPos, vivosNodo, mejoresConsulta);
+    consulta.x = x;
+    consulta.y = y;
+    consulta.visitar(0);
+    return mejoresConsulta.empty() ? -1 : mejoresConsulta[0].second;
+}
+
+void ArbolKD::kMasCercanos(double x, double y, int k, std::vector<int>& resultado,
+                           int excluir) const {
+    resultado.clear();
+    if (nodos.empty() || k <= 0) return;
+    
+    ConsultaVecinos consulta(nodos, indices, xs, ys, marcadoPos, vivosNodo, mejoresConsulta);
+    consulta.x = x;
+    consulta.y = y;
+    consulta.k = k;
+    consulta.excluir = excluir;
+    consulta.visitar(0);
+    
+    std::sort_heap(consulta.mejores.begin(), consulta.mejores.end());
+    for (size_t i = 0; i < consulta.mejores.size(); i++) {
+        resultado.push_back(consulta.mejores[i].second);
+    }
+}
+
+int ArbolKD::construirNodo(const Coordenadas& coordenadas, int ini, int fin) {
+    const Coordenada* cx = coordenadas.datosX();
+    const Coordenada* cy = coordenadas.datosY();
+    Nodo nodo;
+    nodo.ini = ini;
+    nodo.fin = fin;
+    nodo.izq = -1;
+    nodo.der = -1;
+    nodo.minX = nodo.maxX = cx[indices[ini]];
+    nodo.minY = nodo.maxY = cy[indices[ini]];
+    for (int pos = ini + 1; pos < fin; pos++) {
+        double x = cx[indices[pos]];
+        double y = cy[indices[pos]];
+        nodo.minX = std::min(nodo.minX, x);
+        nodo.maxX = std::max(nodo.maxX, x);
+        nodo.minY = std::min(nodo.minY, y);
+        nodo.maxY = std::max(nodo.maxY, y);
+    }
+    
+    int id = nodos.size();
+    nodos.push_back(nodo);
+    
+    if (fin - ini <= TAMANO_HOJA) {
+        return id;
+    }
+    
+    // Dividir por la mediana de la dimensión más extendida
+    ComparaCoordenada comparar;
+    comparar.valores = (nodo.maxX - nodo.minX) >= (nodo.maxY - nodo.minY) ? cx : cy;
+    int medio = ini + (fin - ini) / 2;
+    std::nth_element(indices.begin() + ini, indices.begin() + medio,
+                     indices.begin() + fin, comparar);
+    
+    int izq = construirNodo(coordenadas, ini, medio);
+    int der = construirNodo(coordenadas, medio, fin);
+    nodos[id].izq = izq;
+    nodos[id].der = der;
+    return id;
+}
+
+void ArbolKD::limpiar() {
+    nodos.clear();
+    indices.clear();
+    xs.clear();
+    ys.clear();
+    posDe.clear();
+    marcadoPos.clear();
+    vivosNodo.clear();
+}
@@ -0,0 +1,85 @@
+#ifndef ARBOLKD_H
+#define ARBOLKD_H
+
+#include <vector>
+#include <utility>
+#include "Coordenadas.h"
+
+// Árbol kd bidimensional sobre las coordenadas de los productos.
+// Las coordenadas se guardan permutadas en el orden de las hojas para que
+// los recorridos de cada nodo lean memoria contigua. Los productos pueden
+// marcarse (p. ej. ya recogidos) y las consultas de vecinos los ignoran;
+// cada nodo cuenta sus puntos sin marcar para podar subárboles vacíos.
+class ArbolKD {
+public:
+    // Nodo del árbol: caja envolvente y rango [ini, fin) de posiciones
+    struct Nodo {
+        double minX, maxX, minY, maxY;
+        int ini, fin;
+        int izq, der; // -1 en las hojas
+    };
+    
+    // Máximo de puntos por hoja
+    static const int TAMANO_HOJA = 8;
+    
+    // Construye el árbol para la lista de productos, O(n log n)
+    void construir(const Coordenadas& coordenadas);
+    
+    // Libera el árbol
+    void limpiar();
+    
+    bool vacio() const { return nodos.empty(); }
+    
+    // Marca un producto para que las consultas lo ignoren, O(log n)
+    void marcar(int indice);
+    
+    // Quita todas las marcas
+    void desmarcarTodos();
+    
+    bool marcado(int indice) const { return marcadoPos[posDe[indice]] != 0; }
+    
+    // Producto sin marcar más cercano a (x, y), -1 si no queda ninguno.
+    // Entre distancias iguales gana el menor índice.
+    int masCercano(double x, double y) const;
+    
+    // Los k productos sin marcar más cercanos a (x, y), de menor a mayor
+    // distancia, omitiendo el índice excluir (-1 para no omitir ninguno)
+    void kMasCercanos(double x, double y, int k, std::vector<int>& resultado,
+                      int excluir = -1) const;
+    
+    // Nodos (el 0 es la raíz) y datos permutados por posición
+    const std::vector<Nodo>& getNodos() const { return nodos; }
+    const std::vector<int>& getIndices() const { return indices; }
+    const std::vector<Coordenada>& getXs() const { return xs; }
+    const std::vector<Coordenada>& getYs() const { return ys; }
+    
+    // Clave (Metrica.h) desde (x, y) hasta la caja de un nodo: cota inferior
+    // de la clave hasta cualquiera de sus puntos
+    static double claveCaja(const Nodo& nodo, double x, double y) {
+        double dx = 0.0, dy = 0.0;
+        if (x < nodo.minX) dx = nodo.minX - x;
+        else if (x > nodo.maxX) dx = x - nodo.maxX;
+        if (y < nodo.minY) dy = nodo.minY - y;
+        else if (y > nodo.maxY) dy = y - nodo.maxY;
+        return Metrica::clave(dx, dy);
+    }
+    
+private:
+    std::vector<Nodo> nodos;
+    std::vector<int> indices; // indices[pos] = índice original del producto
+    std::vector<Coordenada> xs; // xs[pos] = x del producto indices[pos]
+    std::vector<Coordenada> ys;
+    std::vector<int> posDe;       // posDe[indice] = posición en el árbol
+    std::vector<char> marcadoPos; // Marca por posición
+    std::vector<int> vivosNodo;   // Puntos sin marcar en cada nodo
+    
+    // Heap de la consulta en curso, reutilizado entre consultas para no
+    // pedir memoria en cada una (un mismo árbol no admite consultas
+    // simultáneas desde varios hilos)
+    mutable std::vector<std::pair<double, int> > mejoresConsulta;
+    
+    // Construye recursivamente el nodo para el rango [ini, fin)
+    int construirNodo(const Coordenadas& coordenadas, int ini, int fin);
+};
+
+#endif
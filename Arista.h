@@ -0,0 +1,23 @@
+#ifndef ARISTA_H
+#define ARISTA_H
+
+// Estructura para representar una arista en el grafo
+struct Arista {
+    int origen;
+    int destino;
+    double peso;
+    
+    Arista(int o, int d, double p) : origen(o), destino(d), peso(p) {}
+    
+    // Para usar en priority_queue (menor peso = mayor prioridad)
+    bool operator>(const Arista& otra) const {
+        return peso > otra.peso;
+    }
+    
+    // Para ordenar de menor a mayor peso
+    bool operator<(const Arista& otra) const {
+        return peso < otra.peso;
+    }
+};
+
+#endif
@@ -0,0 +1,311 @@
+#include "Bodega.h"
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include "Metrica.h"
+#include "PoolHilos.h"
+
+namespace {
+
+const char MAGIA_TABLA[8] = {'B', 'O', 'D', 'E', 'G', 'A', 'D', 'T'};
+const unsigned VERSION_TABLA = 1;
+
+// Celdas máximas del plano (la tabla, no la rejilla, es lo que crece)
+const long long MAX_CELDAS = 1LL << 26;
+
+struct CabeceraTabla {
+    char magia[8];
+    unsigned version;
+    unsigned numUbicaciones;
+    unsigned long long huella;
+};
+
+bool leerArchivo(const std::string& archivo, std::string& contenido) {
+    FILE* f = fopen(archivo.c_str(), "rb");
+    if (f == 0) return false;
+    contenido.clear();
+    char buffer[1 << 16];
+    size_t leidos;
+    while ((leidos = fread(buffer, 1, sizeof(buffer), f)) > 0) {
+        contenido.append(buffer, leidos);
+    }
+    bool ok = !ferror(f);
+    fclose(f);
+    return ok;
+}
+
+// FNV-1a de 64 bits del plano y la métrica: si cambia cualquiera de los
+// dos la tabla guardada deja de valer
+unsigned long long huellaPlano(const std::string& contenido) {
+    unsigned long long h = 1469598103934665603ULL;
+    const char* metrica = Metrica::nombre();
+    for (size_t i = 0; i < contenido.size(); i++) {
+        h = (h ^ (unsigned char)contenido[i]) * 1099511628211ULL;
+    }
+    for (size_t i = 0; metrica[i] != 0; i++) {
+        h = (h ^ (unsigned char)metrica[i]) * 1099511628211ULL;
+    }
+    return h;
+}
+
+}
+
+Bodega::Bodega()
+    : ancho(0), alto(0), tamCelda(1.0), numUbic(0), huella(0), desdeDisco(false) {}
+
+bool Bodega::fallar(const std::string& mensaje) {
+    error = mensaje;
+    return false;
+}
+
+bool Bodega::cargar(const std::string& archivo, int numHilos) {
+    error.clear();
+    desdeDisco = false;
+    if (!leerPlano(archivo)) return false;
+
+    std::string archivoTabla = archivo + ".dist";
+    if (leerTabla(archivoTabla)) {
+        desdeDisco = true;
+        return true;
+    }
+    if (!calcularTabla(numHilos)) return false;
+
+    // Sin permiso de escritura la tabla igual sirve en memoria
+    guardarTabla(archivoTabla);
+    return true;
+}
+
+const Bodega* Bodega::obtener(const std::string& archivo, std::string& error, int numHilos) {
+    static std::mutex mutex;
+    static std::map<unsigned long long, std::unique_ptr<Bodega> > cargadas;
+
+    std::string contenido;
+    if (!leerArchivo(archivo, contenido)) {
+        error = "No se pudo leer el plano " + archivo;
+        return 0;
+    }
+
+    // Se indexa por contenido: el mismo piso con otro nombre no se recalcula
+    std::lock_guard<std::mutex> lock(mutex);
+    std::unique_ptr<Bodega>& bodega = cargadas[huellaPlano(contenido)];
+    if (!bodega) {
+        std::unique_ptr<Bodega> nueva(new Bodega());
+        if (!nueva->cargar(archivo, numHilos)) {
+            error = nueva->getError();
+            cargadas.erase(huellaPlano(contenido));
+            return 0;
+        }
+        bodega.swap(nueva);
+    }
+    return bodega.get();
+}
+
+int Bodega::ubicacionEn(double x, double y) const {
+    double cx = std::floor(x / tamCelda);
+    double cy = std::floor(y / tamCelda);
+    if (!(cx >= 0 && cx < ancho && cy >= 0 && cy < alto)) return -1;
+    return ubicacionCelda[(size_t)cy * ancho + (size_t)cx];
+}
+
+bool Bodega::leerPlano(const std::string& archivo) {
+    std::string contenido;
+    if (!leerArchivo(archivo, contenido)) return fallar("No se pudo leer el plano " + archivo);
+    huella = huellaPlano(contenido);
+
+    std::istringstream entrada(contenido);
+    std::string linea;
+    int numLinea = 0;
+    bool hayCabecera = false;
+    std::vector<std::string> filas; // En el orden del archivo (y mayor primero)
+    while (std::getline(entrada, linea)) {
+        numLinea++;
+        if (!linea.empty() && linea[linea.size() - 1] == '\r') linea.erase(linea.size() - 1);
+        if (!linea.empty() && linea[0] == ';') continue;
+        bool enBlanco = linea.find_first_not_of(" \t") == std::string::npos;
+
+        std::ostringstream donde;
+        donde << "plano " << archivo << ", linea " << numLinea << ": ";
+
+        if (!hayCabecera) {
+            if (enBlanco) continue;
+            char resto;
+            if (sscanf(linea.c_str(), "%d %d %lf %c", &ancho, &alto, &tamCelda, &resto) != 3 ||
+                ancho < 1 || alto < 1 || !(tamCelda > 0) ||
+                (long long)ancho * alto > MAX_CELDAS) {
+                return fallar(donde.str() + "se esperaba \"ancho alto tamCelda\"");
+            }
+            hayCabecera = true;
+            continue;
+        }
+        if ((int)filas.size() == alto) {
+            if (enBlanco) continue;
+            return fallar(donde.str() + "sobran filas");
+        }
+        if ((int)linea.size() < ancho) {
+            return fallar(donde.str() + "la fila tiene menos de ancho celdas");
+        }
+        for (int cx = 0; cx < ancho; cx++) {
+            char c = linea[cx];
+            if (c != '.' && c != '#' && c != 'P') {
+                return fallar(donde.str() + "celda '" + std::string(1, c) +
+                              "' desconocida (use '.', '#' o 'P')");
+            }
+        }
+        filas.push_back(linea);
+    }
+    if (!hayCabecera) return fallar("plano " + archivo + ": vacio");
+    if ((int)filas.size() < alto) return fallar("plano " + archivo + ": faltan filas");
+
+    // Ubicaciones: la base y luego las 'P' por fila desde y = 0
+    libre.assign((size_t)ancho * alto, 0);
+    ubicacionCelda.assign((size_t)ancho * alto, -1);
+    celdaUbicacion.assign(1, 0);
+    for (int cy = 0; cy < alto; cy++) {
+        const std::string& fila = filas[alto - 1 - cy];
+        for (int cx = 0; cx < ancho; cx++) {
+            int celda = cy * ancho + cx;
+            libre[celda] = (fila[cx] != '#');
+            if (fila[cx] == 'P') {
+                ubicacionCelda[celda] = celdaUbicacion.size();
+                celdaUbicacion.push_back(celda);
+            }
+        }
+    }
+    numUbic = celdaUbicacion.size();
+    if (!libre[0]) return fallar("plano " + archivo + ": la celda de la base (0, 0) esta ocupada");
+    return true;
+}
+
+void Bodega::caminosDesde(int celda, std::vector<double>& dist,
+                          std::vector<std::pair<double, int> >& heap) const {
+    const double infinito = std::numeric_limits<double>::infinity();
+    dist.assign((size_t)ancho * alto, infinito);
+    heap.clear();
+    std::greater<std::pair<double, int> > mayor;
+
+    // Costos de un paso según la métrica; si el diagonal no ahorra nada
+    // frente a dos pasos por eje (manhattan) no se usa
+    double paso = tamCelda * Metrica::distancia(1.0, 0.0);
+    double diagonal = tamCelda * Metrica::distancia(1.0, 1.0);
+    bool conDiagonales = diagonal < 2 * paso;
+
+    // Se corta al fijar todas las ubicaciones
+    int faltan = numUbic;
+
+    dist[celda] = 0;
+    heap.push_back(std::make_pair(0.0, celda));
+    while (!heap.empty() && faltan > 0) {
+        std::pop_heap(heap.begin(), heap.end(), mayor);
+        double d = heap.back().first;
+        int actual = heap.back().second;
+        heap.pop_back();
+        if (d > dist[actual]) continue;
+        if (ubicacionCelda[actual] >= 0) faltan--;
+        if (actual == celdaUbicacion[0]) faltan--;
+
+        int cx = actual % ancho;
+        int cy = actual / ancho;
+        for (int dy = -1; dy <= 1; dy++) {
+            for (int dx = -1; dx <= 1; dx++) {
+                if (dx == 0 && dy == 0) continue;
+                int nx = cx + dx, ny = cy + dy;
+                if (nx < 0 || nx >= ancho || ny < 0 || ny >= alto) continue;
+                int vecina = ny * ancho + nx;
+                if (!libre[vecina]) continue;
+                double costo = paso;
+                if (dx != 0 && dy != 0) {
+                    // Sin cortar esquinas: las dos celdas por eje deben estar libres
+                    if (!conDiagonales || !libre[cy * ancho + nx] || !libre[ny * ancho + cx]) continue;
+                    costo = diagonal;
+                }
+                if (d + costo < dist[vecina]) {
+                    dist[vecina] = d + costo;
+                    heap.push_back(std::make_pair(d + costo, vecina));
+                    std::push_heap(heap.begin(), heap.end(), mayor);
+                }
+            }
+        }
+    }
+}
+
+bool Bodega::calcularTabla(int numHilos) {
+    int n = numUbic;
+    tabla.assign((size_t)n * n, 0.0f);
+
+    // Un Dijkstra por ubicación; cada hilo reutiliza sus arreglos
+    PoolHilos pool(numHilos);
+    std::vector<std::vector<double> > dist(pool.getNumHilos());
+    std::vector<std::vector<std::pair<double, int> > > heaps(pool.getNumHilos());
+    pool.ejecutar(n, [&](int u, int hilo) {
+        caminosDesde(celdaUbicacion[u], dist[hilo], heaps[hilo]);
+        float* fila = &tabla[(size_t)u * n];
+        for (int v = 0; v < n; v++) {
+            fila[v] = (float)dist[hilo][celdaUbicacion[v]];
+        }
+    });
+
+    for (int v = 1; v < n; v++) {
+        if (std::isinf(tabla[v])) {
+            int celda = celdaUbicacion[v];
+            std::ostringstream mensaje;
+            mensaje << "la ubicacion (" << celda % ancho << ", " << celda / ancho
+                    << ") no se alcanza desde la base";
+            return fallar(mensaje.str());
+        }
+    }
+
+    // Los caminos en ambos sentidos miden lo mismo salvo el redondeo del
+    // orden de las sumas: se fija la mitad superior para que sea simétrica
+    for (int u = 0; u < n; u++) {
+        for (int v = u + 1; v < n; v++) {
+            tabla[(size_t)v * n + u] = tabla[(size_t)u * n + v];
+        }
+    }
+    return true;
+}
+
+bool Bodega::leerTabla(const std::string& archivo) {
+    FILE* f = fopen(archivo.c_str(), "rb");
+    if (f == 0) return false;
+    CabeceraTabla cabecera;
+    size_t total = (size_t)numUbic * numUbic;
+    bool valida = fread(&cabecera, sizeof(cabecera), 1, f) == 1 &&
+                  memcmp(cabecera.magia, MAGIA_TABLA, 8) == 0 &&
+                  cabecera.version == VERSION_TABLA &&
+                  (int)cabecera.numUbicaciones == numUbic &&
+                  cabecera.huella == huella;
+    if (valida) {
+        tabla.resize(total);
+        valida = fread(&tabla[0], sizeof(float), total, f) == total;
+    }
+    fclose(f);
+    if (!valida) tabla.clear();
+    return valida;
+}
+
+bool Bodega::guardarTabla(const std::string& archivo) const {
+    // Se escribe aparte y se renombra: un proceso que lea a la vez ve la
+    // tabla anterior o la nueva, nunca una a medias
+    std::string temporal = archivo + ".tmp";
+    FILE* f = fopen(temporal.c_str(), "wb");
+    if (f == 0) return false;
+    CabeceraTabla cabecera;
+    memset(&cabecera, 0, sizeof(cabecera));
+    memcpy(cabecera.magia, MAGIA_TABLA, 8);
+    cabecera.version = VERSION_TABLA;
+    cabecera.numUbicaciones = numUbic;
+    cabecera.huella = huella;
+    bool ok = fwrite(&cabecera, sizeof(cabecera), 1, f) == 1 &&
+              fwrite(&tabla[0], sizeof(float), tabla.size(), f) == tabla.size();
+    ok = (fclose(f) == 0) && ok;
+    if (ok) ok = rename(temporal.c_str(), archivo.c_str()) == 0;
+    if (!ok) remove(temporal.c_str());
+    return ok;
+}
@@ -0,0 +1,89 @@
+#ifndef BODEGA_H
+#define BODEGA_H
+
+#include <string>
+#include <vector>
+#include <utility>
+
+// Plano de la bodega como rejilla de ocupación, para medir las distancias
+// por los pasillos en lugar de en línea recta. Formato de texto:
+//   ancho alto tamCelda
+//   alto líneas de ancho caracteres, la primera es la fila de y mayor:
+//     '.' celda libre, '#' estante u obstáculo, 'P' ubicación de picking
+// La celda (cx, cy) cubre [cx·tam, (cx+1)·tam) × [cy·tam, (cy+1)·tam); la
+// base (0, 0) queda en la celda inferior izquierda, que debe estar libre.
+// Las líneas que empiezan con ';' son comentarios.
+//
+// Los productos de los escenarios deben estar en ubicaciones 'P' (todas
+// alcanzables desde la base). Al cargar se calcula una tabla con el camino
+// más corto entre cada par de ubicaciones: un Dijkstra desde cada una
+// sobre la rejilla (movimientos a las 8 vecinas sin cortar esquinas, con el
+// costo de Metrica.h, por lo que en manhattan se mueve solo por ejes). La
+// tabla se guarda junto al plano (archivo + ".dist") y se reutiliza
+// mientras no cambien el plano ni la métrica.
+class Bodega {
+public:
+    Bodega();
+
+    // Lee el plano y obtiene la tabla (del disco si está vigente; si no, la
+    // calcula con numHilos hilos, 0 = todos los núcleos, y la guarda).
+    // false y getError() si el plano no es válido.
+    bool cargar(const std::string& archivo, int numHilos = 1);
+
+    // Bodega ya cargada de ese plano (por contenido) o cargada ahora; las
+    // bodegas quedan en memoria hasta que termina el proceso, así que
+    // escenarios repetidos sobre el mismo piso no vuelven a leer la tabla.
+    // 0 y error si el plano no es válido. Segura entre hilos.
+    static const Bodega* obtener(const std::string& archivo, std::string& error,
+                                 int numHilos = 1);
+
+    // Ubicaciones con la base (siempre la 0)
+    int numUbicaciones() const { return numUbic; }
+
+    // Ubicación de picking de la celda que contiene (x, y); -1 si la celda
+    // está fuera del plano o no es una ubicación
+    int ubicacionEn(double x, double y) const;
+
+    // Camino más corto entre dos ubicaciones
+    double distancia(int a, int b) const { return tabla[(size_t)a * numUbic + b]; }
+
+    int getAncho() const { return ancho; }
+    int getAlto() const { return alto; }
+    double getTamCelda() const { return tamCelda; }
+
+    // Huella del plano y la métrica (distingue bodegas, p. ej. en CacheRutas)
+    unsigned long long getHuella() const { return huella; }
+
+    // La tabla salió del archivo en disco en lugar de calcularse
+    bool tablaDesdeDisco() const { return desdeDisco; }
+
+    const std::string& getError() const { return error; }
+
+private:
+    int ancho, alto;
+    double tamCelda;
+    std::vector<char> libre;        // Por celda (cy * ancho + cx)
+    std::vector<int> ubicacionCelda; // Ubicación de cada celda o -1
+    std::vector<int> celdaUbicacion; // Celda de cada ubicación (la 0 es la base)
+    int numUbic;
+    std::vector<float> tabla;        // numUbic × numUbic, fila por ubicación
+    unsigned long long huella;       // Del plano y la métrica: valida la tabla en disco
+    bool desdeDisco;
+    std::string error;
+
+    bool fallar(const std::string& mensaje);
+    bool leerPlano(const std::string& archivo);
+
+    // Llena la tabla con un Dijkstra por ubicación; false si alguna no es
+    // alcanzable desde la base
+    bool calcularTabla(int numHilos);
+
+    // Dijkstra desde una celda: distancias a todas las celdas
+    void caminosDesde(int celda, std::vector<double>& dist,
+                      std::vector<std::pair<double, int> >& heap) const;
+
+    bool leerTabla(const std::string& archivo);
+    bool guardarTabla(const std::string& archivo) const;
+};
+
+#endif
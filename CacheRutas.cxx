@@ -0,0 +1,297 @@
+#include "CacheRutas.h"
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+
+namespace {
+
+const char MAGIA_CACHE[8] = {'R', 'U', 'T', 'A', 'S', 'C', 'A', 'C'};
+const unsigned VERSION_CACHE = 1;
+
+struct CabeceraCache {
+    char magia[8];
+    unsigned version;
+    unsigned numEntradas;
+    unsigned long long huellaContexto;
+};
+
+struct CabeceraEntrada {
+    int k;
+    int m;
+    int numViajes;
+    double distanciaTotal;
+};
+
+// Mezcla un valor de 64 bits en la huella (finalizador de splitmix64 y un
+// paso de FNV para que importe el orden)
+unsigned long long mezclar(unsigned long long h, unsigned long long valor) {
+    valor = (valor ^ (valor >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    valor = (valor ^ (valor >> 27)) * 0x94D049BB133111EBULL;
+    valor ^= valor >> 31;
+    return (h ^ valor) * 1099511628211ULL;
+}
+
+// Bits de una coordenada, con -0 y 0 iguales como en la comparación
+unsigned long long bitsCoordenada(Coordenada valor) {
+    if (valor == 0) valor = 0;
+    unsigned long long bits = 0;
+    memcpy(&bits, &valor, sizeof(valor));
+    return bits;
+}
+
+unsigned long long huellaInicial(unsigned long long contexto, int k, int m) {
+    return mezclar(mezclar(contexto, (unsigned)k), (unsigned)m);
+}
+
+unsigned long long mezclarPunto(unsigned long long h, Coordenada x, Coordenada y) {
+    return mezclar(mezclar(h, bitsCoordenada(x)), bitsCoordenada(y));
+}
+
+}
+
+CacheRutas::CacheRutas(size_t maxEntradas, const std::string& contexto)
+    : maxEntradas(maxEntradas), productosGuardados(0), aciertos(0), fallos(0), descartes(0) {
+    // FNV-1a del contexto y del tipo de coordenada (un archivo guardado
+    // con float no sirve con double)
+    huellaContexto = 1469598103934665603ULL;
+    for (size_t i = 0; i < contexto.size(); i++) {
+        huellaContexto = (huellaContexto ^ (unsigned char)contexto[i]) * 1099511628211ULL;
+    }
+    huellaContexto = mezclar(huellaContexto, sizeof(Coordenada));
+}
+
+unsigned long long CacheRutas::ordenCanonico(int k, const Coordenadas& coordenadas,
+                                             std::vector<int>& orden) const {
+    int m = coordenadas.size();
+    orden.resize(m);
+    for (int i = 0; i < m; i++) orden[i] = i;
+    std::sort(orden.begin(), orden.end(), [&](int a, int b) {
+        if (coordenadas.x(a) != coordenadas.x(b)) return coordenadas.x(a) < coordenadas.x(b);
+        return coordenadas.y(a) < coordenadas.y(b);
+    });
+
+    unsigned long long h = huellaInicial(huellaContexto, k, m);
+    for (int c = 0; c < m; c++) {
+        h = mezclarPunto(h, coordenadas.x(orden[c]), coordenadas.y(orden[c]));
+    }
+    return h;
+}
+
+bool CacheRutas::coincide(const Entrada& entrada, const std::vector<int>& orden, int k,
+                          const Coordenadas& coordenadas) {
+    if (entrada.k != k || entrada.xs.size() != orden.size()) return false;
+    for (size_t c = 0; c < orden.size(); c++) {
+        if (entrada.xs[c] != coordenadas.x(orden[c]) || entrada.ys[c] != coordenadas.y(orden[c])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool CacheRutas::buscar(unsigned long long huella, const std::vector<int>& orden, int k,
+                        const Coordenadas& coordenadas, Ruta& ruta) {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::unordered_map<unsigned long long, std::list<Entrada>::iterator>::iterator encontrada =
+        indice.find(huella);
+    if (encontrada == indice.end() || !coincide(*encontrada->second, orden, k, coordenadas)) {
+        fallos++;
+        return false;
+    }
+
+    // Pasa a ser la más reciente
+    entradas.splice(entradas.begin(), entradas, encontrada->second);
+    const Entrada& entrada = entradas.front();
+    aciertos++;
+
+    ruta.indices.resize(entrada.indices.size());
+    for (size_t p = 0; p < entrada.indices.size(); p++) {
+        ruta.indices[p] = orden[entrada.indices[p]];
+    }
+    ruta.inicioViaje = entrada.inicioViaje;
+    ruta.distanciaViaje = entrada.distanciaViaje;
+    ruta.distanciaTotal = entrada.distanciaTotal;
+    return true;
+}
+
+void CacheRutas::guardar(unsigned long long huella, const std::vector<int>& orden, int k,
+                         const Coordenadas& coordenadas, const Ruta& ruta) {
+    int m = orden.size();
+    if (m == 0 || (size_t)m > MAX_PRODUCTOS || ruta.numProductos() != m) return;
+
+    // La entrada se arma fuera del candado
+    Entrada entrada;
+    entrada.huella = huella;
+    entrada.k = k;
+    entrada.xs.resize(m);
+    entrada.ys.resize(m);
+    std::vector<int> posicion(m);
+    for (int c = 0; c < m; c++) {
+        entrada.xs[c] = coordenadas.x(orden[c]);
+        entrada.ys[c] = coordenadas.y(orden[c]);
+        posicion[orden[c]] = c;
+    }
+    entrada.indices.resize(m);
+    for (int p = 0; p < m; p++) entrada.indices[p] = posicion[ruta.indices[p]];
+    entrada.inicioViaje = ruta.inicioViaje;
+    entrada.distanciaViaje = ruta.distanciaViaje;
+    entrada.distanciaTotal = ruta.distanciaTotal;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    insertar(entrada);
+}
+
+void CacheRutas::insertar(Entrada& entrada) {
+    std::unordered_map<unsigned long long, std::list<Entrada>::iterator>::iterator anterior =
+        indice.find(entrada.huella);
+    if (anterior != indice.end()) {
+        productosGuardados -= anterior->second->xs.size();
+        entradas.erase(anterior->second);
+        indice.erase(anterior);
+    }
+
+    productosGuardados += entrada.xs.size();
+    // Sin copiar los arreglos: la entrada recibida queda vacía
+    entradas.push_front(Entrada());
+    std::swap(entradas.front(), entrada);
+    indice[entradas.front().huella] = entradas.begin();
+
+    while (entradas.size() > maxEntradas || productosGuardados > MAX_PRODUCTOS) {
+        const Entrada& vieja = entradas.back();
+        productosGuardados -= vieja.xs.size();
+        indice.erase(vieja.huella);
+        entradas.pop_back();
+        descartes++;
+    }
+}
+
+bool CacheRutas::cargar(const std::string& archivo) {
+    FILE* f = fopen(archivo.c_str(), "rb");
+    if (f == 0) return true;
+
+    CabeceraCache cabecera;
+    bool valido = fread(&cabecera, sizeof(cabecera), 1, f) == 1 &&
+                  memcmp(cabecera.magia, MAGIA_CACHE, 8) == 0 &&
+                  cabecera.version == VERSION_CACHE;
+    // Otro contexto (motor, métrica, bodega...): las rutas no corresponden
+    if (!valido || cabecera.huellaContexto != huellaContexto) {
+        fclose(f);
+        return valido;
+    }
+
+    // Se crece de a una entrada: una cabecera dañada no reserva de más
+    std::vector<Entrada> leidas;
+    std::vector<char> marca;
+    for (unsigned e = 0; e < cabecera.numEntradas && valido; e++) {
+        leidas.push_back(Entrada());
+        Entrada& entrada = leidas.back();
+        CabeceraEntrada datos;
+        valido = fread(&datos, sizeof(datos), 1, f) == 1 && datos.k >= 1 && datos.m >= 1 &&
+                 (size_t)datos.m <= MAX_PRODUCTOS && datos.numViajes >= 1 &&
+                 datos.numViajes <= datos.m;
+        if (!valido) break;
+
+        int m = datos.m;
+        entrada.k = datos.k;
+        entrada.distanciaTotal = datos.distanciaTotal;
+        entrada.xs.resize(m);
+        entrada.ys.resize(m);
+        entrada.indices.resize(m);
+        entrada.inicioViaje.resize(datos.numViajes + 1);
+        entrada.distanciaViaje.resize(datos.numViajes);
+        valido = fread(&entrada.xs[0], sizeof(Coordenada), m, f) == (size_t)m &&
+                 fread(&entrada.ys[0], sizeof(Coordenada), m, f) == (size_t)m &&
+                 fread(&entrada.indices[0], sizeof(int), m, f) == (size_t)m &&
+                 fread(&entrada.inicioViaje[0], sizeof(int), datos.numViajes + 1, f) ==
+                     (size_t)datos.numViajes + 1 &&
+                 fread(&entrada.distanciaViaje[0], sizeof(double), datos.numViajes, f) ==
+                     (size_t)datos.numViajes;
+        if (!valido) break;
+
+        // Una ruta mal formada daría viajes inválidos al acertar: los
+        // índices deben ser una permutación y los viajes no vacíos
+        marca.assign(m, 0);
+        for (int p = 0; p < m && valido; p++) {
+            int c = entrada.indices[p];
+            valido = c >= 0 && c < m && !marca[c];
+            if (valido) marca[c] = 1;
+        }
+        valido = valido && entrada.inicioViaje[0] == 0 && entrada.inicioViaje.back() == m;
+        for (int t = 0; t < datos.numViajes && valido; t++) {
+            valido = entrada.inicioViaje[t] < entrada.inicioViaje[t + 1];
+        }
+
+        // La huella se recalcula del contenido en lugar de confiar en el archivo
+        entrada.huella = huellaInicial(huellaContexto, entrada.k, m);
+        for (int c = 0; c < m; c++) {
+            entrada.huella = mezclarPunto(entrada.huella, entrada.xs[c], entrada.ys[c]);
+        }
+    }
+    fclose(f);
+    if (!valido) return false;
+
+    // Del archivo salen de la menos a la más reciente; si no caben todas
+    // quedan las más recientes
+    std::lock_guard<std::mutex> lock(mutex);
+    size_t desde = leidas.size() > maxEntradas ? leidas.size() - maxEntradas : 0;
+    for (size_t e = desde; e < leidas.size(); e++) insertar(leidas[e]);
+    return true;
+}
+
+bool CacheRutas::guardarArchivo(const std::string& archivo) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // Se escribe aparte y se renombra, como la tabla de la bodega
+    std::string temporal = archivo + ".tmp";
+    FILE* f = fopen(temporal.c_str(), "wb");
+    if (f == 0) return false;
+
+    CabeceraCache cabecera;
+    memset(&cabecera, 0, sizeof(cabecera));
+    memcpy(cabecera.magia, MAGIA_CACHE, 8);
+    cabecera.version = VERSION_CACHE;
+    cabecera.numEntradas = entradas.size();
+    cabecera.huellaContexto = huellaContexto;
+    bool ok = fwrite(&cabecera, sizeof(cabecera), 1, f) == 1;
+
+    for (std::list<Entrada>::reverse_iterator e = entradas.rbegin(); e != entradas.rend() && ok; ++e) {
+        CabeceraEntrada datos;
+        memset(&datos, 0, sizeof(datos));
+        datos.k = e->k;
+        datos.m = e->xs.size();
+        datos.numViajes = e->distanciaViaje.size();
+        datos.distanciaTotal = e->distanciaTotal;
+        size_t m = datos.m;
+        size_t viajes = datos.numViajes;
+        ok = fwrite(&datos, sizeof(datos), 1, f) == 1 &&
+             fwrite(&e->xs[0], sizeof(Coordenada), m, f) == m &&
+             fwrite(&e->ys[0], sizeof(Coordenada), m, f) == m &&
+             fwrite(&e->indices[0], sizeof(int), m, f) == m &&
+             fwrite(&e->inicioViaje[0], sizeof(int), viajes + 1, f) == viajes + 1 &&
+             fwrite(&e->distanciaViaje[0], sizeof(double), viajes, f) == viajes;
+    }
+
+    ok = (fclose(f) == 0) && ok;
+    if (ok) ok = rename(temporal.c_str(), archivo.c_str()) == 0;
+    if (!ok) remove(temporal.c_str());
+    return ok;
+}
+
+size_t CacheRutas::numEntradas() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return entradas.size();
+}
+
+long long CacheRutas::getAciertos() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return aciertos;
+}
+
+long long CacheRutas::getFallos() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return fallos;
+}
+
+long long CacheRutas::getDescartes() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return descartes;
+}
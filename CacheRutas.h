@@ -0,0 +1,92 @@
+#ifndef CACHERUTAS_H
+#define CACHERUTAS_H
+
+#include <string>
+#include <vector>
+#include <list>
+#include <unordered_map>
+#include <mutex>
+#include "Coordenadas.h"
+#include "Ruta.h"
+
+// Rutas ya resueltas indexadas por el contenido del escenario, para que los
+// pedidos repetidos (p. ej. reposiciones estándar) no se resuelvan de nuevo.
+// La clave es una huella de k y de los productos en orden canónico
+// (ordenados por x y luego y), así que un mismo conjunto de productos en
+// otro orden también acierta: la ruta se guarda con posiciones canónicas y
+// al acertar se traduce a los índices del escenario. En un acierto se
+// comparan además k y todas las coordenadas, de modo que una colisión de
+// la huella solo cuesta un fallo.
+//
+// Las entradas se descartan por antigüedad de uso (LRU) al superar la
+// cantidad máxima de entradas o de productos guardados. El contexto (motor,
+// mejora, plazo, métrica, bodega...) entra en la huella: una cache solo
+// debe usarse con grafos configurados igual, y un archivo guardado con otro
+// contexto no se carga. Segura entre hilos.
+class CacheRutas {
+public:
+    // Productos guardados como máximo entre todas las entradas (unos 20
+    // bytes por producto en double)
+    static const size_t MAX_PRODUCTOS = 1 << 22;
+
+    CacheRutas(size_t maxEntradas, const std::string& contexto);
+
+    // Deja en orden los productos en orden canónico (orden[c] es el índice
+    // del producto en la posición c) y devuelve la huella del escenario
+    unsigned long long ordenCanonico(int k, const Coordenadas& coordenadas,
+                                     std::vector<int>& orden) const;
+
+    // Busca el escenario; si está deja en ruta sus viajes con los índices
+    // del escenario (conservando ruta.base) y sus distancias
+    bool buscar(unsigned long long huella, const std::vector<int>& orden, int k,
+                const Coordenadas& coordenadas, Ruta& ruta);
+
+    // Guarda la ruta de un escenario recién resuelto como la más reciente
+    void guardar(unsigned long long huella, const std::vector<int>& orden, int k,
+                 const Coordenadas& coordenadas, const Ruta& ruta);
+
+    // Carga las entradas de un archivo guardado con el mismo contexto; true
+    // si no existe (cache vacía), false si no se pudo leer o no es válido
+    bool cargar(const std::string& archivo);
+
+    // Guarda todas las entradas (de la menos a la más reciente); false si
+    // no se pudo escribir
+    bool guardarArchivo(const std::string& archivo);
+
+    size_t numEntradas();
+    long long getAciertos();
+    long long getFallos();
+    long long getDescartes();
+
+private:
+    struct Entrada {
+        unsigned long long huella;
+        int k;
+        std::vector<Coordenada> xs, ys;     // En orden canónico
+        std::vector<int> indices;           // Posiciones canónicas
+        std::vector<int> inicioViaje;
+        std::vector<double> distanciaViaje;
+        double distanciaTotal;
+    };
+
+    size_t maxEntradas;
+    unsigned long long huellaContexto;
+    std::list<Entrada> entradas; // La más reciente primero
+    std::unordered_map<unsigned long long, std::list<Entrada>::iterator> indice;
+    size_t productosGuardados;
+    long long aciertos, fallos, descartes;
+    std::mutex mutex;
+
+    // La entrada coincide con el escenario en k y en cada coordenada
+    static bool coincide(const Entrada& entrada, const std::vector<int>& orden, int k,
+                         const Coordenadas& coordenadas);
+
+    // Inserta como la más reciente (reemplaza la de igual huella) y
+    // descarta las más viejas hasta volver a los límites
+    void insertar(Entrada& entrada);
+
+    CacheRutas(const CacheRutas&);
+    CacheRutas& operator=(const CacheRutas&);
+};
+
+#endif
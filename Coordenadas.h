@@ -0,0 +1,87 @@
+#ifndef COORDENADAS_H
+#define COORDENADAS_H
+
+#include <vector>
+#include <cmath>
+#include <cstddef>
+#include "Producto.h"
+
+// Tipo de las coordenadas almacenadas. double por defecto; con
+// -DCOORDENADAS_FLOAT (make COORDENADAS=float) se guardan en float, con la
+// mitad de memoria y el doble de valores por registro SIMD, a cambio de
+// unas 7 cifras significativas. Las distancias se calculan siempre en double.
+#ifdef COORDENADAS_FLOAT
+typedef float Coordenada;
+#else
+typedef double Coordenada;
+#endif
+
+// Coordenadas de los productos como estructura de arreglos: todas las x y
+// todas las y en dos bloques contiguos, de modo que los recorridos que solo
+// miran posiciones leen memoria compacta y se vectorizan. Producto queda
+// como vista (x, y, índice) que se arma al vuelo con producto(i).
+template <typename T>
+class ArregloCoordenadas {
+public:
+    typedef T Tipo;
+    
+    size_t size() const { return xs.size(); }
+    bool empty() const { return xs.empty(); }
+    
+    void reserve(size_t n) {
+        xs.reserve(n);
+        ys.reserve(n);
+    }
+    
+    void clear() {
+        xs.clear();
+        ys.clear();
+    }
+    
+    void agregar(double x, double y) {
+        xs.push_back((T)x);
+        ys.push_back((T)y);
+    }
+    
+    // Quita el producto i en O(1): el último pasa a ocupar su índice
+    void quitar(int i) {
+        xs[i] = xs.back();
+        ys[i] = ys.back();
+        xs.pop_back();
+        ys.pop_back();
+    }
+    
+    double x(int i) const { return xs[i]; }
+    double y(int i) const { return ys[i]; }
+    
+    // Arreglos contiguos de n valores
+    const T* datosX() const { return xs.data(); }
+    const T* datosY() const { return ys.data(); }
+    
+    // Distancia entre los productos i y j según la métrica (Metrica.h)
+    double distancia(int i, int j) const {
+        return Metrica::distancia((double)xs[i] - (double)xs[j], (double)ys[i] - (double)ys[j]);
+    }
+    
+    // Distancia del producto i al punto (x, y)
+    double distanciaA(int i, double x, double y) const {
+        return Metrica::distancia((double)xs[i] - x, (double)ys[i] - y);
+    }
+    
+    // Clave de comparación del producto i al punto (x, y): ordena igual que
+    // distanciaA sin calcular la raíz en la métrica euclidiana
+    double claveA(int i, double x, double y) const {
+        return Metrica::clave((double)xs[i] - x, (double)ys[i] - y);
+    }
+    
+    // Vista del producto i para la interfaz pública
+    Producto producto(int i) const { return Producto(xs[i], ys[i], i); }
+    
+private:
+    std::vector<T> xs;
+    std::vector<T> ys;
+};
+
+typedef ArregloCoordenadas<Coordenada> Coordenadas;
+
+#endif
@@ -0,0 +1,82 @@
+#include "Distancias.h"
+
+ProveedorDistancias::ProveedorDistancias()
+    : xs(0), ys(0), n(0), modoActivo(DISTANCIAS_DIRECTAS), bodega(0) {}
+
+void ProveedorDistancias::preparar(const Coordenadas& lista, ModoDistancias modo) {
+    xs = lista.empty() ? 0 : lista.datosX();
+    ys = lista.empty() ? 0 : lista.datosY();
+    n = lista.size();
+    
+    if (modo == DISTANCIAS_AUTOMATICO) {
+        modo = (n <= UMBRAL_CACHE_AUTOMATICO) ? DISTANCIAS_CACHE_DOUBLE : DISTANCIAS_DIRECTAS;
+    }
+    modoActivo = modo;
+    
+    cacheDouble.clear();
+    cacheFloat.clear();
+    if (modo == DISTANCIAS_DIRECTAS || n < 2) {
+        return;
+    }
+    
+    // Triangular superior fila por fila: (0,1) (0,2) ... (1,2) (1,3) ...
+    size_t total = (size_t)n * (n - 1) / 2;
+    if (modo == DISTANCIAS_CACHE_FLOAT) {
+        cacheFloat.resize(total);
+    } else {
+        cacheDouble.resize(total);
+    }
+    
+    // Cada fila recorre las coordenadas contiguas y se vectoriza
+    size_t idx = 0;
+    for (int i = 0; i < n; i++) {
+        double xi = xs[i];
+        double yi = ys[i];
+        if (modo == DISTANCIAS_CACHE_FLOAT) {
+            float* fila = &cacheFloat[idx];
+            for (int j = i + 1; j < n; j++) {
+                fila[j - i - 1] = (float)Metrica::distancia(xi - xs[j], yi - ys[j]);
+            }
+        } else {
+            double* fila = &cacheDouble[idx];
+            for (int j = i + 1; j < n; j++) {
+                fila[j - i - 1] = Metrica::distancia(xi - xs[j], yi - ys[j]);
+            }
+        }
+        idx += n - i - 1;
+    }
+}
+
+void ProveedorDistancias::prepararBodega(const Coordenadas& lista, const Bodega& plano) {
+    xs = lista.empty() ? 0 : lista.datosX();
+    ys = lista.empty() ? 0 : lista.datosY();
+    n = lista.size();
+    modoActivo = DISTANCIAS_BODEGA;
+    bodega = &plano;
+    cacheDouble.clear();
+    cacheFloat.clear();
+    
+    // La tabla de la bodega ya es la cache: solo se ubica cada producto
+    ubicaciones.resize(n);
+    for (int i = 0; i < n; i++) {
+        ubicaciones[i] = plano.ubicacionEn(lista.x(i), lista.y(i));
+    }
+}
+
+void ProveedorDistancias::limpiar() {
+    xs = ys = 0;
+    n = 0;
+    // swap para devolver la memoria, clear() conservaría la capacidad
+    std::vector<double>().swap(cacheDouble);
+    std::vector<float>().swap(cacheFloat);
+    std::vector<int>().swap(ubicaciones);
+    bodega = 0;
+}
+
+void ProveedorDistancias::reiniciar() {
+    xs = ys = 0;
+    n = 0;
+    cacheDouble.clear();
+    cacheFloat.clear();
+    ubicaciones.clear();
+}
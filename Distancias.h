@@ -0,0 +1,94 @@
+#ifndef DISTANCIAS_H
+#define DISTANCIAS_H
+
+#include <vector>
+#include <cstddef>
+#include "Coordenadas.h"
+#include "Bodega.h"
+
+// Forma en que se obtienen las distancias entre productos
+enum ModoDistancias {
+    DISTANCIAS_AUTOMATICO,   // Cache para pocos productos, cálculo directo en otro caso
+    DISTANCIAS_DIRECTAS,     // Calcula cada distancia desde las coordenadas (memoria O(n))
+    DISTANCIAS_CACHE_DOUBLE, // Triangular superior contigua en double
+    DISTANCIAS_CACHE_FLOAT,  // Triangular superior contigua en float (mitad de memoria)
+    DISTANCIAS_BODEGA        // Caminos por los pasillos de una Bodega (prepararBodega)
+};
+
+// Proveedor de distancias entre productos. Reemplaza a la matriz de
+// adyacencia densa: por defecto calcula cada distancia al vuelo y solo
+// guarda una cache triangular (n*(n-1)/2 entradas en un único bloque)
+// cuando el escenario es pequeño o se pide explícitamente.
+class ProveedorDistancias {
+private:
+    const Coordenada* xs; // Coordenadas de los productos (no se copian)
+    const Coordenada* ys;
+    int n;
+    ModoDistancias modoActivo; // Nunca es DISTANCIAS_AUTOMATICO una vez preparado
+    std::vector<double> cacheDouble;
+    std::vector<float> cacheFloat;
+    const Bodega* bodega;          // Solo en DISTANCIAS_BODEGA
+    std::vector<int> ubicaciones;  // Ubicación de cada producto en la bodega
+    
+    // Posición de (i, j), con i < j, dentro de la triangular superior
+    size_t indiceTriangular(int i, int j) const {
+        return (size_t)i * (2 * (size_t)n - i - 1) / 2 + (j - i - 1);
+    }
+    
+public:
+    // Máximo de productos para el que el modo automático usa cache
+    static const int UMBRAL_CACHE_AUTOMATICO = 1024;
+    
+    ProveedorDistancias();
+    
+    // Prepara el proveedor para los productos dados (llena la cache si aplica)
+    void preparar(const Coordenadas& coordenadas, ModoDistancias modo);
+    
+    // Prepara el proveedor para medir por los pasillos de la bodega: cada
+    // producto toma la distancia de la ubicación que lo contiene (todos
+    // deben estar en una, ver Bodega::ubicacionEn)
+    void prepararBodega(const Coordenadas& coordenadas, const Bodega& bodega);
+    
+    // Camino del producto i a la base (solo en DISTANCIAS_BODEGA)
+    double distanciaBase(int i) const { return bodega->distancia(0, ubicaciones[i]); }
+    
+    // Libera la cache y olvida los productos
+    void limpiar();
+    
+    // Olvida los productos conservando la memoria de la cache para el
+    // siguiente escenario
+    void reiniciar();
+    
+    // Indica si está preparado para exactamente esta lista de productos
+    bool preparadoPara(const Coordenadas& lista) const {
+        return !lista.empty() && xs == lista.datosX() && n == (int)lista.size();
+    }
+    
+    // Modo efectivamente en uso
+    ModoDistancias getModo() const { return modoActivo; }
+    
+    // Memoria ocupada por la cache (0 en modo directo)
+    size_t bytesCache() const {
+        return cacheDouble.size() * sizeof(double) + cacheFloat.size() * sizeof(float);
+    }
+    
+    // Distancia entre los productos i y j según la métrica (Metrica.h)
+    double distancia(int i, int j) const {
+        if (i == j) return 0.0;
+        if (modoActivo == DISTANCIAS_DIRECTAS) {
+            return Metrica::distancia((double)xs[i] - (double)xs[j], (double)ys[i] - (double)ys[j]);
+        }
+        if (modoActivo == DISTANCIAS_BODEGA) {
+            return bodega->distancia(ubicaciones[i], ubicaciones[j]);
+        }
+        if (i > j) {
+            int tmp = i; i = j; j = tmp;
+        }
+        if (modoActivo == DISTANCIAS_CACHE_FLOAT) {
+            return cacheFloat[indiceTriangular(i, j)];
+        }
+        return cacheDouble[indiceTriangular(i, j)];
+    }
+};
+
+#endif
@@ -0,0 +1,89 @@
+#include "EscritorSalida.h"
+#include <unistd.h>
+
+namespace {
+
+// Espacio que se garantiza libre antes de formatear una línea; un double con
+// "%.2f" ocupa a lo sumo ~320 caracteres
+const size_t MARGEN_LINEA = 1024;
+
+}
+
+EscritorSalida::EscritorSalida(size_t tamanoBuffer)
+    : archivo(0), buffer(tamanoBuffer < 4 * MARGEN_LINEA ? 4 * MARGEN_LINEA : tamanoBuffer),
+      usado(0), fallo(false) {}
+
+EscritorSalida::~EscritorSalida() {
+    if (archivo != 0) cerrar();
+}
+
+bool EscritorSalida::abrir(const std::string& nombre) {
+    if (archivo != 0) cerrar();
+    archivo = fopen(nombre.c_str(), "w");
+    if (archivo == 0) return false;
+    // El buffer propio reemplaza al de stdio
+    setvbuf(archivo, 0, _IONBF, 0);
+    usado = 0;
+    fallo = false;
+    return true;
+}
+
+bool EscritorSalida::abrirDescriptor(int descriptor) {
+    if (archivo != 0) cerrar();
+    // Una copia del descriptor: cerrar() no cierra el original
+    int copia = dup(descriptor);
+    if (copia < 0) return false;
+    archivo = fdopen(copia, "w");
+    if (archivo == 0) {
+        close(copia);
+        return false;
+    }
+    setvbuf(archivo, 0, _IONBF, 0);
+    usado = 0;
+    fallo = false;
+    return true;
+}
+
+bool EscritorSalida::vaciar() {
+    if (archivo == 0) return false;
+    volcar();
+    return !fallo;
+}
+
+void EscritorSalida::volcar() {
+    if (usado > 0 && fwrite(&buffer[0], 1, usado, archivo) != usado) fallo = true;
+    usado = 0;
+}
+
+void EscritorSalida::escribirLinea(long long valor) {
+    if (buffer.size() - usado < MARGEN_LINEA) volcar();
+    usado += snprintf(&buffer[usado], buffer.size() - usado, "%lld\n", valor);
+}
+
+void EscritorSalida::escribirPunto(double x, double y) {
+    if (buffer.size() - usado < 2 * MARGEN_LINEA) volcar();
+    usado += snprintf(&buffer[usado], buffer.size() - usado, "%.2f %.2f\n", x, y);
+}
+
+void EscritorSalida::escribirRuta(int k, const Ruta& ruta, const Coordenadas& coordenadas) {
+    escribirLinea(k);
+    escribirLinea(ruta.numParadas());
+    if (ruta.numViajes() == 0) return;
+    
+    escribirPunto(ruta.base.x, ruta.base.y);
+    for (int t = 0; t < ruta.numViajes(); t++) {
+        for (int p = ruta.inicioViaje[t]; p < ruta.inicioViaje[t + 1]; p++) {
+            int i = ruta.indices[p];
+            escribirPunto(coordenadas.x(i), coordenadas.y(i));
+        }
+        escribirPunto(ruta.base.x, ruta.base.y);
+    }
+}
+
+bool EscritorSalida::cerrar() {
+    if (archivo == 0) return false;
+    volcar();
+    if (fclose(archivo) != 0) fallo = true;
+    archivo = 0;
+    return !fallo;
+}
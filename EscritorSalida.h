@@ -0,0 +1,57 @@
+#ifndef ESCRITORSALIDA_H
+#define ESCRITORSALIDA_H
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "Ruta.h"
+
+// Escritor del archivo de salida de texto:
+//   n
+//   k
+//   tamaño de la ruta
+//   x y   (dos decimales)
+//   ...
+// Acumula en un buffer grande y lo vuelca entero cuando se llena, sin
+// vaciar por línea; los errores de escritura se informan al cerrar.
+class EscritorSalida {
+public:
+    explicit EscritorSalida(size_t tamanoBuffer = 1 << 20);
+    ~EscritorSalida();
+    
+    bool abrir(const std::string& archivo);
+    
+    // Escribe en un descriptor ya abierto (salida estándar, socket); cerrar()
+    // no lo cierra
+    bool abrirDescriptor(int descriptor);
+    
+    // Escribe un entero en su propia línea
+    void escribirLinea(long long valor);
+    
+    // Escribe "x y" con dos decimales
+    void escribirPunto(double x, double y);
+    
+    // Escribe un escenario resuelto: k, tamaño de la ruta y sus puntos, con
+    // la base al inicio y al final de cada viaje
+    void escribirRuta(int k, const Ruta& ruta, const Coordenadas& coordenadas);
+    
+    // Vuelca el buffer sin cerrar (p. ej. tras cada respuesta en modo
+    // flujo); false si alguna escritura falló
+    bool vaciar();
+    
+    // Vuelca el buffer y cierra; false si alguna escritura falló
+    bool cerrar();
+    
+private:
+    FILE* archivo;
+    std::vector<char> buffer;
+    size_t usado;
+    bool fallo;
+    
+    void volcar();
+    
+    EscritorSalida(const EscritorSalida&);
+    EscritorSalida& operator=(const EscritorSalida&);
+};
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef ESPACIOTRABAJO_H
+#define ESPACIOTRABAJO_H
+
+#include <vector>
+#include <utility>
+#include "Arista.h"
+#include "MST.h"
+
+// Memoria de trabajo del resolvedor, reutilizable entre escenarios. Los
+// arreglos se vacían con clear()/assign() y nunca se liberan, así que crecen
+// hasta el escenario más grande y a partir de ahí resolver otro no pide
+// memoria. Cada Grafo trae uno propio; con Grafo::usarEspacioTrabajo se lo
+// puede ligar a uno externo (uno por hilo, nunca compartido entre hilos).
+struct EspacioTrabajo {
+    EspacioMST mst;                    // Prim denso y Borůvka (MST.h)
+    std::vector<Arista> heapPrim;      // Cola de prioridad de algoritmoPrim
+    std::vector<char> enMST;           // Nodos ya incorporados por algoritmoPrim
+
+    std::vector<int> cursor;                    // Llenado de las listas de adyacencia
+    std::vector<char> visitado;                 // DFS del árbol
+    std::vector<std::pair<int, int> > pilaDFS;  // (nodo, próximo vecino por revisar)
+    std::vector<int> tamano;                    // Tamaños de subárbol
+
+    std::vector<int> siguientePos;     // Armado de viajes sobre el preorden
+    std::vector<int> subir;
+    std::vector<int> ordenBase;        // Con bodega: productos por camino a la base
+    std::vector<int> ordenCanonico;    // Clave de CacheRutas
+
+    std::vector<int> vecinos;          // Listas de vecinos de la mejora y los ahorros
+    std::vector<int> cercanos;
+    std::vector<std::vector<int> > viajes; // Viajes sueltos para la mejora local
+    
+    std::vector<int> candidatos;       // Modo incremental: vecinos por octante,
+    std::vector<int> camino;           // caminos en el árbol
+    std::vector<int> colaCamino;
+    std::vector<int> colaCaminoB;
+    std::vector<int> vecinosQuitado;   // y reconexión de un producto eliminado
+    std::vector<Arista> reconexion;
+    std::vector<int> parteReconexion;
+};
+
+#endif
@@ -0,0 +1,256 @@
+#include "FormatoBinario.h"
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace {
+
+const size_t TAMANO_CABECERA = 32;
+
+struct CabeceraBinaria {
+    char magia[8];
+    unsigned version;
+    unsigned tipo;
+    unsigned long long numRegistros;
+    unsigned long long desplIndice;
+};
+
+struct CabeceraRegistro {
+    int k;
+    int reservado;
+    unsigned long long m;
+};
+
+size_t alinear8(size_t bytes) {
+    return (bytes + 7) & ~(size_t)7;
+}
+
+}
+
+// ============================================================================
+// ArchivoBinario
+// ============================================================================
+
+ArchivoBinario::ArchivoBinario()
+    : datos(0), tamano(0), tipo(BINARIO_ESCENARIOS), numRegistros(0), indice(0) {}
+
+ArchivoBinario::~ArchivoBinario() {
+    cerrar();
+}
+
+bool ArchivoBinario::esBinario(const std::string& archivo) {
+    FILE* f = fopen(archivo.c_str(), "rb");
+    if (f == 0) return false;
+    char magia[8];
+    bool binario = fread(magia, 1, 8, f) == 8 && memcmp(magia, MAGIA_BINARIO, 8) == 0;
+    fclose(f);
+    return binario;
+}
+
+bool ArchivoBinario::fallar(const std::string& mensaje) {
+    error = mensaje;
+    cerrar();
+    return false;
+}
+
+bool ArchivoBinario::abrir(const std::string& archivo) {
+    cerrar();
+    error.clear();
+    
+    int fd = open(archivo.c_str(), O_RDONLY);
+    if (fd < 0) return fallar("no se pudo abrir el archivo");
+    
+    struct stat info;
+    if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode) || (size_t)info.st_size < TAMANO_CABECERA) {
+        close(fd);
+        return fallar("archivo demasiado corto para el formato binario");
+    }
+    void* proyeccion = mmap(0, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (proyeccion == MAP_FAILED) return fallar("no se pudo proyectar el archivo");
+    datos = static_cast<const char*>(proyeccion);
+    tamano = info.st_size;
+    
+    CabeceraBinaria cabecera;
+    memcpy(&cabecera, datos, sizeof(cabecera));
+    if (memcmp(cabecera.magia, MAGIA_BINARIO, 8) != 0) {
+        return fallar("firma del formato binario incorrecta");
+    }
+    if (cabecera.version != VERSION_FORMATO_BINARIO) {
+        return fallar("version de formato binario no soportada");
+    }
+    if (cabecera.tipo != BINARIO_ESCENARIOS && cabecera.tipo != BINARIO_RUTAS) {
+        return fallar("tipo de archivo binario desconocido");
+    }
+    if (cabecera.desplIndice % 8 != 0 || cabecera.desplIndice > tamano ||
+        cabecera.numRegistros > (tamano - cabecera.desplIndice) / 8) {
+        return fallar("indice fuera del archivo");
+    }
+    tipo = (TipoBinario)cabecera.tipo;
+    numRegistros = cabecera.numRegistros;
+    indice = reinterpret_cast<const unsigned long long*>(datos + cabecera.desplIndice);
+    
+    // Validar todos los registros una vez para que registro() no necesite hacerlo
+    for (size_t i = 0; i < numRegistros; i++) {
+        unsigned long long despl = indice[i];
+        if (despl % 8 != 0 || despl < TAMANO_CABECERA || despl > cabecera.desplIndice ||
+            cabecera.desplIndice - despl < sizeof(CabeceraRegistro)) {
+            return fallar("registro fuera del archivo");
+        }
+        const CabeceraRegistro* reg = reinterpret_cast<const CabeceraRegistro*>(datos + despl);
+        size_t disponible = cabecera.desplIndice - despl - sizeof(CabeceraRegistro);
+        if (reg->k < 1 || reg->m > disponible / 16) {
+            return fallar("registro con datos invalidos");
+        }
+        if (tipo == BINARIO_ESCENARIOS) continue;
+        
+        disponible -= reg->m * 16;
+        if (disponible < 8) return fallar("registro de ruta incompleto");
+        const unsigned long long* numViajes =
+            reinterpret_cast<const unsigned long long*>(datos + despl + sizeof(CabeceraRegistro) + reg->m * 16);
+        disponible -= 8;
+        if (*numViajes >= disponible / 8) return fallar("registro de ruta incompleto");
+        const unsigned long long* inicioViaje = numViajes + 1;
+        disponible -= (*numViajes + 1) * 8;
+        if (reg->m > disponible / 4) return fallar("registro de ruta incompleto");
+        
+        if (inicioViaje[0] != 0 || inicioViaje[*numViajes] != reg->m) {
+            return fallar("desplazamientos de viajes invalidos");
+        }
+        for (size_t t = 0; t < *numViajes; t++) {
+            if (inicioViaje[t] > inicioViaje[t + 1]) return fallar("desplazamientos de viajes invalidos");
+        }
+        const unsigned* indices = reinterpret_cast<const unsigned*>(inicioViaje + *numViajes + 1);
+        for (size_t j = 0; j < reg->m; j++) {
+            if (indices[j] >= reg->m) return fallar("indice de producto fuera de rango");
+        }
+    }
+    return true;
+}
+
+void ArchivoBinario::cerrar() {
+    if (datos != 0) {
+        munmap(const_cast<char*>(datos), tamano);
+        datos = 0;
+        tamano = 0;
+    }
+    numRegistros = 0;
+    indice = 0;
+}
+
+RegistroBinario ArchivoBinario::registro(size_t i) const {
+    const char* p = datos + indice[i];
+    const CabeceraRegistro* reg = reinterpret_cast<const CabeceraRegistro*>(p);
+    p += sizeof(CabeceraRegistro);
+    
+    RegistroBinario r;
+    r.k = reg->k;
+    r.m = reg->m;
+    r.xs = reinterpret_cast<const double*>(p);
+    r.ys = r.xs + r.m;
+    r.numViajes = 0;
+    r.inicioViaje = 0;
+    r.indices = 0;
+    if (tipo == BINARIO_RUTAS) {
+        const unsigned long long* numViajes = reinterpret_cast<const unsigned long long*>(r.ys + r.m);
+        r.numViajes = *numViajes;
+        r.inicioViaje = numViajes + 1;
+        r.indices = reinterpret_cast<const unsigned*>(r.inicioViaje + r.numViajes + 1);
+    }
+    return r;
+}
+
+// ============================================================================
+// EscritorBinario
+// ============================================================================
+
+EscritorBinario::EscritorBinario() : archivo(0), tipo(BINARIO_ESCENARIOS), posicion(0) {}
+
+EscritorBinario::~EscritorBinario() {
+    if (archivo != 0) cerrar();
+}
+
+bool EscritorBinario::escribir(const void* datos, size_t bytes) {
+    if (bytes == 0) return true;
+    if (fwrite(datos, 1, bytes, archivo) != bytes) return false;
+    posicion += bytes;
+    return true;
+}
+
+bool EscritorBinario::escribirCabecera(unsigned long long desplIndice) {
+    CabeceraBinaria cabecera;
+    memcpy(cabecera.magia, MAGIA_BINARIO, 8);
+    cabecera.version = VERSION_FORMATO_BINARIO;
+    cabecera.tipo = tipo;
+    cabecera.numRegistros = desplazamientos.size();
+    cabecera.desplIndice = desplIndice;
+    return fwrite(&cabecera, 1, sizeof(cabecera), archivo) == sizeof(cabecera);
+}
+
+bool EscritorBinario::abrir(const std::string& nombre, TipoBinario tipoArchivo) {
+    if (archivo != 0) cerrar();
+    archivo = fopen(nombre.c_str(), "wb");
+    if (archivo == 0) return false;
+    tipo = tipoArchivo;
+    desplazamientos.clear();
+    
+    // Cabecera provisional; se reescribe al cerrar
+    if (!escribirCabecera(0)) return false;
+    posicion = TAMANO_CABECERA;
+    return true;
+}
+
+bool EscritorBinario::agregarEscenario(int k, const std::vector<double>& coordenadas) {
+    if (archivo == 0 || tipo != BINARIO_ESCENARIOS) return false;
+    size_t m = coordenadas.size() / 2;
+    
+    desplazamientos.push_back(posicion);
+    CabeceraRegistro reg = {k, 0, m};
+    if (!escribir(&reg, sizeof(reg))) return false;
+    
+    std::vector<double> columna(m);
+    for (size_t i = 0; i < m; i++) columna[i] = coordenadas[2 * i];
+    if (!escribir(columna.data(), m * sizeof(double))) return false;
+    for (size_t i = 0; i < m; i++) columna[i] = coordenadas[2 * i + 1];
+    return escribir(columna.data(), m * sizeof(double));
+}
+
+bool EscritorBinario::agregarRuta(int k, const Coordenadas& coordenadas, const Ruta& ruta) {
+    if (archivo == 0 || tipo != BINARIO_RUTAS) return false;
+    size_t m = coordenadas.size();
+    if ((size_t)ruta.numProductos() != m) return false;
+    
+    std::vector<unsigned> indices(ruta.indices.begin(), ruta.indices.end());
+    std::vector<unsigned long long> inicioViaje(ruta.inicioViaje.begin(), ruta.inicioViaje.end());
+    
+    desplazamientos.push_back(posicion);
+    CabeceraRegistro reg = {k, 0, m};
+    if (!escribir(&reg, sizeof(reg))) return false;
+    
+    std::vector<double> columna(m);
+    for (size_t i = 0; i < m; i++) columna[i] = coordenadas.x(i);
+    if (!escribir(columna.data(), m * sizeof(double))) return false;
+    for (size_t i = 0; i < m; i++) columna[i] = coordenadas.y(i);
+    if (!escribir(columna.data(), m * sizeof(double))) return false;
+    
+    unsigned long long numViajes = inicioViaje.size() - 1;
+    if (!escribir(&numViajes, sizeof(numViajes))) return false;
+    if (!escribir(inicioViaje.data(), inicioViaje.size() * sizeof(unsigned long long))) return false;
+    if (!escribir(indices.data(), m * sizeof(unsigned))) return false;
+    
+    // Relleno hasta múltiplo de 8 para el siguiente registro
+    static const char ceros[8] = {0};
+    return escribir(ceros, alinear8(posicion) - posicion);
+}
+
+bool EscritorBinario::cerrar() {
+    if (archivo == 0) return false;
+    unsigned long long desplIndice = posicion;
+    bool ok = escribir(desplazamientos.data(), desplazamientos.size() * sizeof(unsigned long long));
+    ok = ok && fseek(archivo, 0, SEEK_SET) == 0 && escribirCabecera(desplIndice);
+    ok = (fclose(archivo) == 0) && ok;
+    archivo = 0;
+    return ok;
+}
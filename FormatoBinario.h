@@ -0,0 +1,116 @@
+#ifndef FORMATOBINARIO_H
+#define FORMATOBINARIO_H
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "Ruta.h"
+
+// Contenedor binario versionado para escenarios y rutas (little-endian):
+//
+//   Cabecera (32 bytes)
+//     char     magia[8]      "GRAFOBIN"
+//     uint32   version       VERSION_FORMATO_BINARIO
+//     uint32   tipo          BINARIO_ESCENARIOS o BINARIO_RUTAS
+//     uint64   numRegistros
+//     uint64   desplIndice   posición del índice
+//   Registros (alineados a 8 bytes), uno por escenario
+//     int32 k, int32 reservado, uint64 m
+//     double xs[m], double ys[m]
+//     solo en rutas: uint64 numViajes,
+//                    uint64 inicioViaje[numViajes + 1],
+//                    uint32 indices[m]   (orden de visita; el viaje t ocupa
+//                                         indices[inicioViaje[t] .. inicioViaje[t+1]))
+//   Índice
+//     uint64 desplRegistro[numRegistros]
+//
+// El archivo se lee proyectado en memoria y cada registro se accede
+// directamente por su número, sin recorrer los anteriores.
+
+const char MAGIA_BINARIO[8] = {'G', 'R', 'A', 'F', 'O', 'B', 'I', 'N'};
+const unsigned VERSION_FORMATO_BINARIO = 1;
+
+enum TipoBinario {
+    BINARIO_ESCENARIOS = 0,
+    BINARIO_RUTAS = 1
+};
+
+// Vista de un registro dentro del archivo proyectado (no copia datos)
+struct RegistroBinario {
+    int k;
+    size_t m;
+    const double* xs;
+    const double* ys;
+    // Solo en archivos de rutas
+    size_t numViajes;
+    const unsigned long long* inicioViaje;
+    const unsigned* indices;
+};
+
+// Lectura de un archivo binario proyectado en memoria
+class ArchivoBinario {
+public:
+    ArchivoBinario();
+    ~ArchivoBinario();
+    
+    // Indica si el archivo empieza con la firma del formato binario
+    static bool esBinario(const std::string& archivo);
+    
+    // Proyecta y valida el archivo; false y getError() si no es válido
+    bool abrir(const std::string& archivo);
+    void cerrar();
+    
+    TipoBinario getTipo() const { return tipo; }
+    size_t getNumRegistros() const { return numRegistros; }
+    
+    // Acceso aleatorio al registro i (se valida al abrir)
+    RegistroBinario registro(size_t i) const;
+    
+    const std::string& getError() const { return error; }
+    
+private:
+    const char* datos;
+    size_t tamano;
+    TipoBinario tipo;
+    size_t numRegistros;
+    const unsigned long long* indice;
+    std::string error;
+    
+    bool fallar(const std::string& mensaje);
+    
+    ArchivoBinario(const ArchivoBinario&);
+    ArchivoBinario& operator=(const ArchivoBinario&);
+};
+
+// Escritura secuencial de un archivo binario; el índice se agrega al cerrar
+class EscritorBinario {
+public:
+    EscritorBinario();
+    ~EscritorBinario();
+    
+    bool abrir(const std::string& archivo, TipoBinario tipo);
+    
+    // Agrega un escenario con coordenadas intercaladas x0 y0 x1 y1 ...
+    bool agregarEscenario(int k, const std::vector<double>& coordenadas);
+    
+    // Agrega la ruta de un escenario; sus índices y desplazamientos de
+    // viaje se copian tal cual al registro
+    bool agregarRuta(int k, const Coordenadas& coordenadas, const Ruta& ruta);
+    
+    // Escribe índice y cabecera definitivos
+    bool cerrar();
+    
+private:
+    FILE* archivo;
+    TipoBinario tipo;
+    std::vector<unsigned long long> desplazamientos;
+    unsigned long long posicion;
+    
+    bool escribir(const void* datos, size_t bytes);
+    bool escribirCabecera(unsigned long long desplIndice);
+    
+    EscritorBinario(const EscritorBinario&);
+    EscritorBinario& operator=(const EscritorBinario&);
+};
+
+#endif
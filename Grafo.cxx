@@ -1,60 +1,153 @@
 #include "Grafo.h"
 #include <iostream>
 #include <iomanip>
+#include "PoolHilos.h"
 
-Grafo::Grafo(int k) : capacidad(k), base(0, 0, -1) {}
+Grafo::Grafo(int k) : modoDistancias(DISTANCIAS_AUTOMATICO), bodega(0), motorMST(MST_AUTOMATICO), hilosMST(1),
+      poolMST(0), base(0, 0, -1), capacidad(k),
+      mstValido(false), arbolValido(false), rutaValida(false), cacheEscenarios(0),
+      rutaDesdeCache(false), indiceValido(false),
+      presupuestoMejoraMs(0), motorRuteo(RUTEO_MST), plazoMs(0), espacioExterno(0),
+      modoIncremental(false), incrementalListo(false), selloCamino(0) {}
+
+void Grafo::setCapacidad(int k) {
+    if (k != capacidad) {
+        capacidad = k;
+        rutaValida = false;
+        incrementalListo = false;
+    }
+}
+
+void Grafo::setPresupuestoMejora(double ms) {
+    if (ms != presupuestoMejoraMs) {
+        presupuestoMejoraMs = ms;
+        rutaValida = false;
+        incrementalListo = false;
+    }
+}
+
+void Grafo::setPlazo(double ms) {
+    if (ms != plazoMs) {
+        plazoMs = ms;
+        rutaValida = false;
+        incrementalListo = false;
+    }
+}
+
+void Grafo::setMotorRuteo(MotorRuteo motor) {
+    if (motor != motorRuteo) {
+        motorRuteo = motor;
+        rutaValida = false;
+        incrementalListo = false;
+    }
+}
+
+void Grafo::setMotorMST(MotorMST motor) {
+    if (motor != motorMST) {
+        motorMST = motor;
+        invalidarEtapas();
+        incrementalListo = false;
+    }
+}
 
 void Grafo::agregarProducto(double x, double y) {
-    productos.push_back(Producto(x, y, productos.size()));
+    coordenadas.agregar(x, y);
+    if (incrementalListo) insertarIncremental(coordenadas.size() - 1);
+    invalidarEtapas();
 }
 
-void Grafo::construirMatrizAdyacencia() {
-    int n = productos.size();
-    matrizAdyacencia.assign(n, std::vector<double>(n, 0.0));
+bool Grafo::eliminarProducto(int indice) {
+    int ultimo = (int)coordenadas.size() - 1;
+    if (indice < 0 || indice > ultimo) return false;
     
-    // Calcula distancias entre todos los pares de productos (grafo completo)
-    for (int i = 0; i < n; i++) {
-        for (int j = 0; j < n; j++) {
-            if (i != j) {
-                matrizAdyacencia[i][j] = productos[i].distanciaA(productos[j]);
-            }
-        }
+    if (incrementalListo) {
+        quitarIncremental(indice);
+        renombrarIncremental(ultimo, indice);
+    }
+    coordenadas.quitar(indice);
+    
+    // Con el mismo tamaño y los mismos arreglos la cache parecería vigente
+    distancias.reiniciar();
+    invalidarEtapas();
+    if (incrementalListo && rejilla.desbalanceada()) rejilla.construir(coordenadas);
+    return true;
+}
+
+void Grafo::setModoIncremental(bool activo) {
+    modoIncremental = activo;
+    incrementalListo = false;
+    if (activo && rutaValida) iniciarIncremental();
+}
+
+void Grafo::prepararDistancias() {
+    // El grafo sigue siendo completo, pero las distancias se obtienen bajo
+    // demanda: solo se reserva memoria cuadrática si el modo usa cache
+    if (!distancias.preparadoPara(coordenadas)) {
+        MEDIR_ETAPA(tiempos.distancias);
+        if (bodega != 0) distancias.prepararBodega(coordenadas, *bodega);
+        else distancias.preparar(coordenadas, modoDistancias);
+    }
+}
+
+void Grafo::usarBodega(const Bodega* plano) {
+    if (plano != bodega) {
+        bodega = plano;
+        distancias.limpiar();
+        invalidarEtapas();
+        incrementalListo = false;
+    }
+}
+
+void Grafo::setModoDistancias(ModoDistancias modo) {
+    if (modo != modoDistancias) {
+        modoDistancias = modo;
+        distancias.limpiar();
     }
 }
 
 // ============================================
 // ALGORITMO DE PRIM - Árbol de Expansión Mínima
 // ============================================
-std::vector<Arista> Grafo::algoritmoPrim() {
-    int n = productos.size();
+// La cola de prioridad es un heap sobre heapPrim del espacio de trabajo
+// (push_heap/pop_heap, igual que std::priority_queue) para reutilizar su
+// memoria entre escenarios.
+void Grafo::algoritmoPrim(std::vector<Arista>& mst) {
+    int n = coordenadas.size();
+    mst.clear(); // Árbol de expansión mínima resultante
     if (n == 0) {
-        return std::vector<Arista>();
+        return;
     }
     
     if (n == 1) {
         // Solo hay un producto, no hay árbol que construir
-        return std::vector<Arista>();
+        return;
     }
     
-    std::vector<Arista> mst; // Árbol de expansión mínima resultante
-    std::vector<bool> enMST(n, false); // Nodos ya incluidos en el MST
-    std::priority_queue<Arista, std::vector<Arista>, std::greater<Arista>> pq;
+    std::vector<char>& enMST = espacio().enMST; // Nodos ya incluidos en el MST
+    enMST.assign(n, 0);
+    std::vector<Arista>& pq = espacio().heapPrim;
+    pq.clear();
+    std::greater<Arista> mayor;
     
     // Paso 1: Comenzar desde el nodo más cercano a la base
-    int nodoInicial = nodoMasCercanoABase(enMST);
-    enMST[nodoInicial] = true;
+    int nodoInicial = nodoMasCercanoABase();
+    enMST[nodoInicial] = 1;
     
     // Paso 2: Agregar todas las aristas del nodo inicial a la cola de prioridad
     for (int i = 0; i < n; i++) {
-        if (i != nodoInicial && matrizAdyacencia.size() > 0) {
-            pq.push(Arista(nodoInicial, i, matrizAdyacencia[nodoInicial][i]));
+        if (i != nodoInicial) {
+            pq.push_back(Arista(nodoInicial, i, distancias.distancia(nodoInicial, i)));
+            std::push_heap(pq.begin(), pq.end(), mayor);
+            CONTAR(contadores.insercionesHeap, 1);
         }
     }
     
     // Paso 3: Algoritmo de Prim - Seleccionar arista de menor peso
     while (!pq.empty() && (int)mst.size() < n - 1) {
-        Arista aristaActual = pq.top();
-        pq.pop();
+        std::pop_heap(pq.begin(), pq.end(), mayor);
+        Arista aristaActual = pq.back();
+        pq.pop_back();
+        CONTAR(contadores.extraccionesHeap, 1);
         
         int destino = aristaActual.destino;
         
@@ -63,33 +156,143 @@ std::vector<Arista> Grafo::algoritmoPrim() {
         
         // Agregar arista al MST
         mst.push_back(aristaActual);
-        enMST[destino] = true;
+        enMST[destino] = 1;
         
         // Agregar todas las aristas del nuevo nodo a la cola
         for (int i = 0; i < n; i++) {
             if (!enMST[i]) {
-                pq.push(Arista(destino, i, matrizAdyacencia[destino][i]));
+                pq.push_back(Arista(destino, i, distancias.distancia(destino, i)));
+                std::push_heap(pq.begin(), pq.end(), mayor);
+                CONTAR(contadores.insercionesHeap, 1);
             }
         }
     }
     
-    return mst;
+    // Cada inserción evaluó una distancia
+    CONTAR(contadores.evaluacionesDistancia, contadores.insercionesHeap);
+}
+
+void Grafo::calcularMST(std::vector<Arista>& mst) {
+    if (bodega != 0) {
+        // Los caminos por los pasillos no son una métrica del plano: ni el
+        // árbol kd ni el kernel geométrico sirven, solo la tabla
+        prepararDistancias();
+        MEDIR_ETAPA(tiempos.mst);
+        algoritmoPrimTabla(mst);
+        CONTAR(contadores.evaluacionesDistancia,
+               (unsigned long long)coordenadas.size() * (coordenadas.size() - 1) / 2);
+        return;
+    }
+    
+    MotorMST motor = motorMST;
+    if (motor == MST_AUTOMATICO) {
+        int n = coordenadas.size();
+        if (plazoMs > 0) {
+            // Con plazo importa poder estimar el costo: el Prim denso
+            // (cuadrático) solo mientras es el más rápido
+            motor = (n <= UMBRAL_PLAZO_PRIM_DENSO) ? MST_PRIM_DENSO : MST_BORUVKA_KD;
+        } else if (n <= UMBRAL_MST_PRIM_HEAP) motor = MST_PRIM_HEAP;
+        else if (n <= UMBRAL_MST_PRIM_DENSO) motor = MST_PRIM_DENSO;
+        else motor = MST_BORUVKA_KD;
+    }
+    
+    // Índice (raíz) y distancias se preparan antes para no contarlos en el MST
+    prepararIndiceEspacial();
+    if (motor == MST_PRIM_HEAP) prepararDistancias();
+    
+    MEDIR_ETAPA(tiempos.mst);
+    mst.clear();
+    if (motor == MST_BORUVKA_KD && poolMST != 0) {
+        mstBoruvkaKD(indiceEspacial, mst, espacio().mst, &contadores.evaluacionesDistancia,
+                     poolMST->getNumHilos() > 1 ? poolMST : 0);
+    } else if (motor == MST_BORUVKA_KD && hilosMST != 1) {
+        // Pool propio de esta llamada: Borůvka se elige desde
+        // UMBRAL_MST_PRIM_DENSO productos (con plazo, desde
+        // UMBRAL_PLAZO_PRIM_DENSO), donde crear los hilos pesa poco frente
+        // al MST; para muchos escenarios seguidos conviene usarPoolMST
+        PoolHilos pool(hilosMST);
+        mstBoruvkaKD(indiceEspacial, mst, espacio().mst, &contadores.evaluacionesDistancia,
+                     pool.getNumHilos() > 1 ? &pool : 0);
+    } else if (motor == MST_BORUVKA_KD) {
+        mstBoruvkaKD(indiceEspacial, mst, espacio().mst, &contadores.evaluacionesDistancia);
+    } else if (motor == MST_PRIM_DENSO) {
+        if (coordenadas.size() >= 2) {
+            mstPrimDenso(coordenadas, nodoMasCercanoABase(), mst, espacio().mst);
+        }
+        // Cada paso evalúa la distancia a todos los nodos pendientes
+        CONTAR(contadores.evaluacionesDistancia,
+               (unsigned long long)coordenadas.size() * (coordenadas.size() - 1) / 2);
+    } else {
+        algoritmoPrim(mst);
+    }
+}
+
+void Grafo::algoritmoPrimTabla(std::vector<Arista>& mst) {
+    int n = coordenadas.size();
+    mst.clear();
+    if (n < 2) return;
+    mst.reserve(n - 1);
+    
+    // Pendientes compactados al inicio, como en mstPrimDenso: al incorporar
+    // un nodo se intercambia con el último
+    std::vector<int>& ids = espacio().mst.ids;
+    std::vector<double>& dist = espacio().mst.dist;
+    std::vector<double>& padre = espacio().mst.padre;
+    int actual = nodoMasCercanoABase();
+    ids.clear();
+    for (int i = 0; i < n; i++) {
+        if (i != actual) ids.push_back(i);
+    }
+    dist.assign(n - 1, std::numeric_limits<double>::infinity());
+    padre.assign(n - 1, (double)actual);
+    
+    for (int r = n - 1; r > 0; r--) {
+        int elegido = 0;
+        for (int p = 0; p < r; p++) {
+            double d = distancias.distancia(actual, ids[p]);
+            if (d < dist[p]) {
+                dist[p] = d;
+                padre[p] = actual;
+            }
+            if (dist[p] < dist[elegido]) elegido = p;
+        }
+        actual = ids[elegido];
+        mst.push_back(Arista((int)padre[elegido], actual, dist[elegido]));
+        ids[elegido] = ids[r - 1];
+        dist[elegido] = dist[r - 1];
+        padre[elegido] = padre[r - 1];
+    }
 }
 
 void Grafo::construirMSTListasAdyacencia(const std::vector<Arista>& mst) {
-    int n = productos.size();
-    listasAdyacencia.clear();
-    listasAdyacencia.assign(n, std::vector<int>());
+    int n = coordenadas.size();
     
-    // Construir grafo no dirigido (árbol) desde el MST
+    // Árbol no dirigido en formato CSR: los vecinos de v ocupan
+    // vecinosArbol[inicioVecinos[v] .. inicioVecinos[v+1]) en orden de aristas
+    inicioVecinos.assign(n + 1, 0);
     for (size_t i = 0; i < mst.size(); i++) {
         const Arista& arista = mst[i];
         
         // Verificar índices válidos
         if (arista.origen >= 0 && arista.origen < n &&
             arista.destino >= 0 && arista.destino < n) {
-            listasAdyacencia[arista.origen].push_back(arista.destino);
-            listasAdyacencia[arista.destino].push_back(arista.origen);
+            inicioVecinos[arista.origen + 1]++;
+            inicioVecinos[arista.destino + 1]++;
+        }
+    }
+    for (int v = 0; v < n; v++) {
+        inicioVecinos[v + 1] += inicioVecinos[v];
+    }
+    
+    vecinosArbol.resize(inicioVecinos[n]);
+    std::vector<int>& cursor = espacio().cursor;
+    cursor.assign(inicioVecinos.begin(), inicioVecinos.end() - 1);
+    for (size_t i = 0; i < mst.size(); i++) {
+        const Arista& arista = mst[i];
+        if (arista.origen >= 0 && arista.origen < n &&
+            arista.destino >= 0 && arista.destino < n) {
+            vecinosArbol[cursor[arista.origen]++] = arista.destino;
+            vecinosArbol[cursor[arista.destino]++] = arista.origen;
         }
     }
 }
@@ -97,158 +300,958 @@ void Grafo::construirMSTListasAdyacencia(const std::vector<Arista>& mst) {
 // ============================================
 // DFS - Recorrido en Profundidad del MST
 // ============================================
-void Grafo::dfsRecorrido(int nodo, std::vector<bool>& visitado, std::vector<int>& recorrido) {
-    // Verificar límites
-    if (nodo < 0 || nodo >= (int)productos.size()) {
+// Iterativo con pila explícita: un MST con forma de camino (pasillos
+// largos) tiene profundidad cercana a n y desbordaría la pila de llamadas.
+// Produce el mismo preorden que la versión recursiva.
+void Grafo::dfsRecorrido(int nodo, std::vector<char>& visitado, std::vector<int>& recorrido) {
+    // Verificar límites una sola vez
+    if (nodo < 0 || nodo >= (int)coordenadas.size() || nodo >= (int)visitado.size() ||
+        inicioVecinos.size() != coordenadas.size() + 1) {
         return;
     }
     
-    if (nodo >= (int)visitado.size()) {
-        return;
+    // Cada entrada es (nodo, siguiente posición por revisar en vecinosArbol)
+    std::vector<std::pair<int, int> >& pila = espacio().pilaDFS;
+    pila.clear();
+    visitado[nodo] = 1;
+    recorrido.push_back(nodo);
+    pila.push_back(std::make_pair(nodo, inicioVecinos[nodo]));
+    CONTAR(contadores.visitasDFS, 1);
+    
+    while (!pila.empty()) {
+        std::pair<int, int>& tope = pila.back();
+        if (tope.second == inicioVecinos[tope.first + 1]) {
+            pila.pop_back();
+            continue;
+        }
+        
+        int vecino = vecinosArbol[tope.second++];
+        if (!visitado[vecino]) {
+            visitado[vecino] = 1;
+            recorrido.push_back(vecino);
+            pila.push_back(std::make_pair(vecino, inicioVecinos[vecino]));
+            CONTAR(contadores.visitasDFS, 1);
+        }
+    }
+}
+
+void Grafo::prepararIndiceEspacial() {
+    if (!indiceValido) {
+        MEDIR_ETAPA(tiempos.indice);
+        indiceEspacial.construir(coordenadas);
+        indiceValido = true;
+    }
+}
+
+int Grafo::nodoMasCercanoABase() {
+    if (coordenadas.empty()) return 0;
+    if (bodega != 0) {
+        prepararDistancias();
+        int mejor = 0;
+        for (int i = 1; i < (int)coordenadas.size(); i++) {
+            if (distancias.distanciaBase(i) < distancias.distanciaBase(mejor)) mejor = i;
+        }
+        return mejor;
     }
+    prepararIndiceEspacial();
+    CONTAR(contadores.consultasIndice, 1);
+    return indiceEspacial.masCercano(base.x, base.y);
+}
+
+void Grafo::vecinosMasCercanos(int indice, int k, std::vector<int>& resultado) {
+    resultado.clear();
+    if (indice < 0 || indice >= (int)coordenadas.size()) return;
+    prepararIndiceEspacial();
+    const Producto p = coordenadas.producto(indice);
+    CONTAR(contadores.consultasIndice, 1);
+    indiceEspacial.kMasCercanos(p.x, p.y, k, resultado, indice);
+}
+
+// ============================================
+// ETAPAS DEL RESOLVEDOR (con cache por escenario)
+// ============================================
+// distancias -> MST -> listas de adyacencia del árbol -> viajes.
+// Cada etapa se calcula a lo sumo una vez; agregarProducto() y limpiar()
+// invalidan todas.
+
+void Grafo::invalidarEtapas() {
+    tiempos = TiemposEtapas();
+    contadores = ContadoresGrafo();
+    indiceValido = false;
+    mstValido = false;
+    arbolValido = false;
+    rutaValida = false;
+}
+
+const std::vector<Arista>& Grafo::obtenerMST() {
+    if (!mstValido) {
+        if (incrementalListo) {
+            // El árbol incremental ya está armado: solo se listan sus aristas
+            mstCache.clear();
+            for (int u = 0; u < (int)adyacenciaInc.size(); u++) {
+                for (size_t i = 0; i < adyacenciaInc[u].size(); i++) {
+                    int v = adyacenciaInc[u][i];
+                    if (u < v) mstCache.push_back(Arista(u, v, coordenadas.distancia(u, v)));
+                }
+            }
+        } else {
+            calcularMST(mstCache);
+        }
+        mstValido = true;
+    }
+    return mstCache;
+}
+
+void Grafo::prepararArbolMST() {
+    if (!arbolValido) {
+        const std::vector<Arista>& mst = obtenerMST();
+        prepararIndiceEspacial(); // La raíz se busca en el índice
+        MEDIR_ETAPA(tiempos.recorrido);
+        construirMSTListasAdyacencia(mst);
+        calcularPreorden();
+        arbolValido = true;
+    }
+}
+
+void Grafo::calcularPreorden() {
+    int n = coordenadas.size();
+    preorden.clear();
+    posPreorden.assign(n, -1);
+    finSubarbol.assign(n, 0);
+    padreArbol.assign(n, -1);
+    if (n == 0) return;
     
-    visitado[nodo] = true;
-    recorrido.push_back(nodo);
+    // Un solo DFS desde la raíz sirve para todos los viajes
+    std::vector<char>& visitado = espacio().visitado;
+    visitado.assign(n, 0);
+    dfsRecorrido(nodoMasCercanoABase(), visitado, preorden);
+    
+    for (int pos = 0; pos < n; pos++) {
+        posPreorden[preorden[pos]] = pos;
+    }
     
-    // Visitar todos los vecinos en el MST
-    if (nodo < (int)listasAdyacencia.size()) {
-        for (size_t i = 0; i < listasAdyacencia[nodo].size(); i++) {
-            int vecino = listasAdyacencia[nodo][i];
-            if (vecino >= 0 && vecino < (int)visitado.size() && !visitado[vecino]) {
-                dfsRecorrido(vecino, visitado, recorrido);
+    // En un árbol, el único vecino que aparece antes en el preorden es el padre
+    for (int pos = 1; pos < n; pos++) {
+        int v = preorden[pos];
+        for (int i = inicioVecinos[v]; i < inicioVecinos[v + 1]; i++) {
+            int u = vecinosArbol[i];
+            if (posPreorden[u] < pos) {
+                padreArbol[v] = u;
+                break;
             }
         }
     }
+    
+    // Tamaños de subárbol acumulados de las hojas hacia la raíz
+    std::vector<int>& tamano = espacio().tamano;
+    tamano.assign(n, 1);
+    for (int pos = n - 1; pos > 0; pos--) {
+        int v = preorden[pos];
+        tamano[padreArbol[v]] += tamano[v];
+    }
+    for (int v = 0; v < n; v++) {
+        finSubarbol[v] = posPreorden[v] + tamano[v];
+    }
 }
 
-int Grafo::nodoMasCercanoABase(const std::vector<bool>& visitado) {
-    double minDist = std::numeric_limits<double>::max();
-    int masCercano = 0;
+const Ruta& Grafo::obtenerRuta() {
+    // Escenario repetido: la ruta sale de la cache traducida a sus índices
+    bool consultarCache = !rutaValida && cacheEscenarios != 0 && !modoIncremental &&
+                          !coordenadas.empty();
+    unsigned long long huellaEscenario = 0;
+    std::vector<int>& ordenCanonico = espacio().ordenCanonico;
+    if (consultarCache) {
+        huellaEscenario = cacheEscenarios->ordenCanonico(capacidad, coordenadas, ordenCanonico);
+        if (cacheEscenarios->buscar(huellaEscenario, ordenCanonico, capacidad, coordenadas,
+                                    rutaCache)) {
+            CONTAR(contadores.viajes, rutaCache.numViajes());
+            rutaValida = true;
+            rutaDesdeCache = true;
+            return rutaCache;
+        }
+    }
     
-    for (size_t i = 0; i < productos.size(); i++) {
-        if (!visitado[i]) {
-            double dist = base.distanciaA(productos[i]);
-            if (dist < minDist) {
-                minDist = dist;
-                masCercano = i;
+    if (!rutaValida) rutaDesdeCache = false;
+    if (!rutaValida && incrementalListo) {
+        // Los viajes incrementales ya están al día: solo se copian
+        MEDIR_ETAPA(tiempos.viajes);
+        armarRuta(viajesInc);
+    } else if (!rutaValida && plazoMs > 0 && bodega == 0) {
+        resolverConPlazoInterno();
+    } else if (!rutaValida) {
+        // Con bodega solo el preorden del MST mide por los pasillos
+        MotorRuteo motor = (bodega != 0) ? RUTEO_MST : motorRuteo;
+        if (motor == RUTEO_MST) prepararArbolMST();
+        prepararIndiceEspacial();
+        
+        {
+            MEDIR_ETAPA(tiempos.viajes);
+            if (motor == RUTEO_AHORROS) {
+                std::vector<int>& vecinos = espacio().vecinos;
+                int numVecinos = calcularListasVecinos(VECINOS_AHORROS, vecinos);
+                armarRuta(viajesAhorros(coordenadas, base, capacidad, vecinos, numVecinos));
+            } else if (motor == RUTEO_BARRIDO) {
+                armarRuta(viajesBarrido(coordenadas, base, capacidad));
+            } else {
+                extraerViajes();
             }
         }
+        
+        resultadoMejora = ResultadoMejora();
+        tiempos.mejora = 0;
+        if (presupuestoMejoraMs > 0 && bodega == 0) {
+            MEDIR_ETAPA(tiempos.mejora);
+            mejorarRuta();
+        }
     }
     
-    return masCercano;
+    if (!rutaValida) {
+        if (bodega != 0) {
+            rutaCache.distanciaTotal = medirRutaBodega(rutaCache, &rutaCache.distanciaViaje);
+        } else {
+            rutaCache.calcularDistancias(coordenadas);
+        }
+        CONTAR(contadores.viajes, rutaCache.numViajes());
+        rutaValida = true;
+        if (plazoMs > 0 && !incrementalListo) resultadoPlazo.distancia = rutaCache.distanciaTotal;
+        if (modoIncremental && !incrementalListo && bodega == 0) iniciarIncremental();
+        if (consultarCache) {
+            cacheEscenarios->guardar(huellaEscenario, ordenCanonico, capacidad, coordenadas, rutaCache);
+        }
+    }
+    return rutaCache;
 }
 
 // ============================================
 // ALGORITMO DEL VECINO MÁS CERCANO POR VIAJES
 // ============================================
-std::vector<Producto> Grafo::resolverEnrutamientoVecinoMasCercano() {
-    if (productos.empty()) return std::vector<Producto>();
+namespace {
+
+// Busca con compresión de caminos el representante de x en un arreglo de
+// enlaces donde enlace[x] == x marca a los representantes
+int buscarEnlace(std::vector<int>& enlace, int x) {
+    int raiz = x;
+    while (enlace[raiz] != raiz) {
+        raiz = enlace[raiz];
+    }
+    while (enlace[x] != raiz) {
+        int sig = enlace[x];
+        enlace[x] = raiz;
+        x = sig;
+    }
+    return raiz;
+}
+
+}
+
+void Grafo::extraerViajes() {
+    Ruta& rutaFinal = rutaCache;
+    rutaFinal.limpiar(base);
+    int n = coordenadas.size();
+    if (n == 0) return;
+    rutaFinal.indices.reserve(n);
     
-    // 1. Construir MST
-    construirMatrizAdyacencia();
-    std::vector<Arista> mst = algoritmoPrim();
-    construirMSTListasAdyacencia(mst);
+    // Semillas: el índice espacial responde "pendiente más cercano a la
+    // base"; cada producto recogido se marca en él. Con bodega la cercanía
+    // es por los pasillos: los productos se ordenan una vez por su camino a
+    // la base y se avanza sobre ese orden saltando los recogidos.
+    prepararIndiceEspacial();
+    indiceEspacial.desmarcarTodos();
+    std::vector<int>& ordenBase = espacio().ordenBase;
+    std::vector<char>& recogido = espacio().visitado;
+    int siguienteSemilla = 0;
+    if (bodega != 0) {
+        prepararDistancias();
+        ordenBase.resize(n);
+        for (int i = 0; i < n; i++) ordenBase[i] = i;
+        const ProveedorDistancias& d = distancias;
+        std::sort(ordenBase.begin(), ordenBase.end(), [&d](int a, int b) {
+            double da = d.distanciaBase(a), db = d.distanciaBase(b);
+            return da < db || (da == db && a < b);
+        });
+        recogido.assign(n, 0);
+    }
+    
+    // siguientePos[p]: primera posición de preorden >= p aún no recogida
+    std::vector<int>& siguientePos = espacio().siguientePos;
+    siguientePos.resize(n + 1);
+    for (int p = 0; p <= n; p++) {
+        siguientePos[p] = p;
+    }
     
-    std::vector<Producto> rutaFinal;
-    std::vector<bool> visitados(productos.size(), false);
-    int pendientes = productos.size();
+    // subir[v]: ancestro (o v mismo) más bajo cuyo subárbol tiene pendientes;
+    // n representa "ninguno" (se agotó el árbol completo)
+    std::vector<int>& subir = espacio().subir;
+    subir.resize(n + 1);
+    for (int v = 0; v <= n; v++) {
+        subir[v] = v;
+    }
     
-    rutaFinal.push_back(base); // Comenzar en base
+    int pendientes = n;
     
     while (pendientes > 0) {
-        // Encontrar nodo más cercano a la base NO visitado
-        int nodoActual = -1;
-        double minDist = std::numeric_limits<double>::max();
+        // Semilla: producto pendiente más cercano a la base
+        int nodoActual;
+        if (bodega != 0) {
+            while (recogido[ordenBase[siguienteSemilla]]) siguienteSemilla++;
+            nodoActual = ordenBase[siguienteSemilla];
+        } else {
+            nodoActual = indiceEspacial.masCercano(base.x, base.y);
+            CONTAR(contadores.consultasIndice, 1);
+        }
         
-        for (int i = 0; i < productos.size(); i++) {
-            if (!visitados[i]) {
-                double dist = base.distanciaA(productos[i]);
-                if (dist < minDist) {
-                    minDist = dist;
-                    nodoActual = i;
-                }
+        // Recoger hasta k productos: primero el subárbol de la semilla y,
+        // al agotarse, el del ancestro pendiente más bajo
+        int productosEnViaje = 0;
+        while (productosEnViaje < capacidad && pendientes > 0) {
+            int v = buscarEnlace(subir, nodoActual);
+            while (v < n && buscarEnlace(siguientePos, posPreorden[v]) >= finSubarbol[v]) {
+                subir[v] = (padreArbol[v] >= 0) ? padreArbol[v] : n;
+                v = buscarEnlace(subir, v);
+            }
+            if (v == n) break;
+            nodoActual = v;
+            
+            int pos = buscarEnlace(siguientePos, posPreorden[v]);
+            while (pos < finSubarbol[v] && productosEnViaje < capacidad) {
+                int idx = preorden[pos];
+                rutaFinal.agregar(idx);
+                if (bodega != 0) recogido[idx] = 1;
+                else indiceEspacial.marcar(idx);
+                siguientePos[pos] = pos + 1;
+                productosEnViaje++;
+                pendientes--;
+                pos = buscarEnlace(siguientePos, pos + 1);
             }
         }
         
-        if (nodoActual == -1) break;
+        // Regresar a base
+        rutaFinal.cerrarViaje();
+    }
+    
+    indiceEspacial.desmarcarTodos();
+}
+
+// ============================================
+// MEJORA LOCAL DE LOS VIAJES
+// ============================================
+void Grafo::mejorarRuta() {
+    int n = coordenadas.size();
+    if (n < 2) return;
+    
+    std::vector<std::vector<int> >& viajes = espacio().viajes;
+    separarViajes(viajes);
+    
+    std::vector<int>& vecinos = espacio().vecinos;
+    int numVecinos = calcularListasVecinos(VECINOS_MEJORA, vecinos);
+    
+    resultadoMejora = mejorarViajes(coordenadas, base, viajes, capacidad,
+                                    vecinos, numVecinos, presupuestoMejoraMs);
+    armarRuta(viajes);
+}
+
+void Grafo::separarViajes(std::vector<std::vector<int> >& viajes) const {
+    viajes.resize(rutaCache.numViajes());
+    for (int t = 0; t < rutaCache.numViajes(); t++) {
+        viajes[t].assign(rutaCache.indices.begin() + rutaCache.inicioViaje[t],
+                         rutaCache.indices.begin() + rutaCache.inicioViaje[t + 1]);
+    }
+}
+
+// ============================================
+// RESOLUCIÓN CON PLAZO
+// ============================================
+namespace {
+
+// Costo estimado de cada etapa en múltiplos del barrido del mismo
+// escenario, que sirve de reloj de la máquina y del tamaño a la vez.
+// Medidos hasta 100000 productos (con margen): el MST y los ahorros crecen
+// con log n respecto del barrido, las listas de vecinos no.
+double unidadesMST(int n) { return std::max(4.0, 2.75 * std::log2((double)n) - 14); }
+double unidadesAhorros(int n) { return 3 * std::log2((double)n) + 15; }
+const double UNIDADES_VECINOS = 12;
+
+}
+
+void Grafo::resolverConPlazoInterno() {
+    typedef std::chrono::steady_clock Reloj;
+    Reloj::time_point inicio = Reloj::now();
+    Reloj::time_point limite = inicio + std::chrono::microseconds((long long)(plazoMs * 1000.0));
+    
+    // Resto del plazo en ms (negativo si ya venció)
+    auto restanteMs = [&]() {
+        return std::chrono::duration<double, std::milli>(limite - Reloj::now()).count();
+    };
+    
+    resultadoPlazo = ResultadoPlazo();
+    resultadoMejora = ResultadoMejora();
+    tiempos.mejora = 0;
+    int n = coordenadas.size();
+    std::vector<std::vector<int> >& viajes = espacio().viajes;
+    std::vector<int>& vecinos = espacio().vecinos;
+    int numVecinos = -1; // Listas de vecinos aún sin calcular
+    double unidad = 0;   // Tiempo del barrido: reloj de las estimaciones
+    
+    {
+        // Con plazo, la etapa de viajes incluye el MST de su motor
+        MEDIR_ETAPA(tiempos.viajes);
+        
+        // Primera ruta válida: el barrido no necesita MST ni vecinos
+        viajes = viajesBarrido(coordenadas, base, capacidad);
+        double mejor = distanciaViajes(coordenadas, base, viajes);
+        resultadoPlazo.distanciaInicial = mejor;
+        resultadoPlazo.primeraRutaMs = std::chrono::duration<double, std::milli>(
+            Reloj::now() - inicio).count();
+        resultadoPlazo.motoresProbados = 1;
         
-        // Hacer DFS desde este nodo para recoger k productos
-        std::vector<bool> visitadoLocal(productos.size(), false);
-        std::vector<int> recorrido;
-        dfsRecorrido(nodoActual, visitadoLocal, recorrido);
+        // Un piso para el reloj: en escenarios diminutos el barrido mide ruido
+        unidad = std::max(resultadoPlazo.primeraRutaMs, 0.001);
         
-        // Agregar productos al recorrido (hasta completar k)
-        int productosEnViaje = 0;
-        for (int idx : recorrido) {
-            if (!visitados[idx] && productosEnViaje < capacidad) {
-                rutaFinal.push_back(productos[idx]);
-                visitados[idx] = true;
-                productosEnViaje++;
-                pendientes--;
+        // Motores del más barato al más caro: el preorden del MST (cuyo
+        // algoritmo ya se elige por tamaño, ver MST.h) y los ahorros
+        if (n >= 2 && restanteMs() > unidadesMST(n) * unidad) {
+            prepararArbolMST();
+            extraerViajes();
+            resultadoPlazo.motoresProbados++;
+            double distancia = rutaCache.medirDistancias(coordenadas);
+            if (distancia < mejor) {
+                mejor = distancia;
+                separarViajes(viajes);
+                resultadoPlazo.motor = RUTEO_MST;
+            }
+        }
+        if (n >= 2 && restanteMs() > unidadesAhorros(n) * unidad) {
+            prepararIndiceEspacial();
+            numVecinos = calcularListasVecinos(VECINOS_AHORROS, vecinos);
+            std::vector<std::vector<int> > candidato =
+                viajesAhorros(coordenadas, base, capacidad, vecinos, numVecinos);
+            resultadoPlazo.motoresProbados++;
+            if (distanciaViajes(coordenadas, base, candidato) < mejor) {
+                viajes.swap(candidato);
+                resultadoPlazo.motor = RUTEO_AHORROS;
             }
-            if (productosEnViaje >= capacidad) break;
+        }
+    }
+    
+    // Mejora local con lo que queda, reservando una unidad para armar la
+    // ruta y un margen para que la búsqueda note el plazo. Las listas de
+    // los ahorros sirven: sus primeros VECINOS_MEJORA vecinos son los de la
+    // mejora.
+    if (n >= 2) {
+        if (numVecinos < 0) {
+            if (restanteMs() > (UNIDADES_VECINOS + 1) * unidad) {
+                prepararIndiceEspacial();
+                numVecinos = calcularListasVecinos(VECINOS_MEJORA, vecinos);
+            }
+        } else if (numVecinos > VECINOS_MEJORA) {
+            // La fila 0 ya está en su lugar; desde la 1 el destino queda
+            // antes del origen y std::copy hacia adelante es válido
+            for (int i = 1; i < n; i++) {
+                std::copy(vecinos.begin() + (size_t)i * numVecinos,
+                          vecinos.begin() + (size_t)i * numVecinos + VECINOS_MEJORA,
+                          vecinos.begin() + (size_t)i * VECINOS_MEJORA);
+            }
+            numVecinos = VECINOS_MEJORA;
+            vecinos.resize((size_t)n * numVecinos);
         }
         
-        // Regresar a base si quedan productos
-        if (pendientes > 0) {
-            rutaFinal.push_back(base);
+        double restante = restanteMs() - unidad - plazoMs * MARGEN_PLAZO_PORCIENTO / 100;
+        if (numVecinos >= 0 && restante > 0) {
+            MEDIR_ETAPA(tiempos.mejora);
+            resultadoMejora = mejorarViajes(coordenadas, base, viajes, capacidad,
+                                            vecinos, numVecinos, restante);
         }
     }
     
-    // Regreso final
-    if (rutaFinal.back().x != 0 || rutaFinal.back().y != 0) {
-        rutaFinal.push_back(base);
+    armarRuta(viajes);
+    resultadoPlazo.tiempoMs = std::chrono::duration<double, std::milli>(Reloj::now() - inicio).count();
+    resultadoPlazo.plazoCumplido = resultadoPlazo.tiempoMs <= plazoMs;
+}
+
+int Grafo::calcularListasVecinos(int numVecinos, std::vector<int>& vecinos) {
+    int n = coordenadas.size();
+    numVecinos = std::max(0, std::min(numVecinos, n - 1));
+    vecinos.assign((size_t)n * numVecinos, -1);
+    
+    std::vector<int>& cercanos = espacio().cercanos;
+    for (int i = 0; i < n; i++) {
+        vecinosMasCercanos(i, numVecinos, cercanos);
+        std::copy(cercanos.begin(), cercanos.end(), vecinos.begin() + (size_t)i * numVecinos);
     }
+    return numVecinos;
+}
+
+void Grafo::armarRuta(const std::vector<std::vector<int> >& viajes) {
+    rutaCache.limpiar(base);
+    rutaCache.indices.reserve(coordenadas.size());
+    for (size_t t = 0; t < viajes.size(); t++) {
+        for (size_t i = 0; i < viajes[t].size(); i++) {
+            rutaCache.agregar(viajes[t][i]);
+        }
+        rutaCache.cerrarViaje();
+    }
+}
+
+// ============================================
+// MODO INCREMENTAL
+// ============================================
+// El MST se guarda como listas de adyacencia mutables y los viajes como
+// listas sueltas. Agregar un producto lo conecta a los más cercanos de cada
+// octante (la rejilla los da sin recorrer todo) y aplica la propiedad del
+// ciclo: el MST con el producto nuevo es exacto. Eliminar uno reconecta sus
+// ex vecinos con el MST entre ellos y luego prueba las aristas a los
+// cercanos de cada uno; el resultado es siempre un árbol de expansión,
+// cercano al mínimo. En ambos casos solo se replanifica el viaje afectado.
+
+namespace {
+
+// Distancia entre dos paradas de un viaje; -1 representa la base
+double tramo(const Coordenadas& coordenadas, const Producto& base, int a, int b) {
+    if (a < 0 && b < 0) return 0.0;
+    if (a < 0) return coordenadas.distanciaA(b, base.x, base.y);
+    if (b < 0) return coordenadas.distanciaA(a, base.x, base.y);
+    return coordenadas.distancia(a, b);
+}
+
+// Quita v de una lista de vecinos (el orden no importa)
+void quitarVecino(std::vector<int>& lista, int v) {
+    std::vector<int>::iterator it = std::find(lista.begin(), lista.end(), v);
+    if (it != lista.end()) {
+        *it = lista.back();
+        lista.pop_back();
+    }
+}
+
+// Ordena productos por distancia a un producto de referencia
+struct PorDistanciaA {
+    const Coordenadas& coordenadas;
+    int referencia;
+    
+    PorDistanciaA(const Coordenadas& c, int r) : coordenadas(c), referencia(r) {}
     
-    return rutaFinal;
+    bool operator()(int a, int b) const {
+        double da = coordenadas.distancia(referencia, a);
+        double db = coordenadas.distancia(referencia, b);
+        return da < db || (da == db && a < b);
+    }
+};
+
 }
 
+void Grafo::iniciarIncremental() {
+    const std::vector<Arista>& mst = obtenerMST();
+    int n = coordenadas.size();
+    
+    adyacenciaInc.resize(n);
+    for (int v = 0; v < n; v++) {
+        adyacenciaInc[v].clear();
+    }
+    for (size_t i = 0; i < mst.size(); i++) {
+        adyacenciaInc[mst[i].origen].push_back(mst[i].destino);
+        adyacenciaInc[mst[i].destino].push_back(mst[i].origen);
+    }
+    
+    viajesInc.resize(rutaCache.numViajes());
+    viajeDe.assign(n, -1);
+    for (int t = 0; t < rutaCache.numViajes(); t++) {
+        viajesInc[t].assign(rutaCache.indices.begin() + rutaCache.inicioViaje[t],
+                            rutaCache.indices.begin() + rutaCache.inicioViaje[t + 1]);
+        for (size_t i = 0; i < viajesInc[t].size(); i++) {
+            viajeDe[viajesInc[t][i]] = t;
+        }
+    }
+    
+    marcaCamino.assign(n, 0);
+    padreCamino.assign(n, -1);
+    selloCamino = 0;
+    rejilla.construir(coordenadas);
+    incrementalListo = true;
+}
 
-// Versión que retorna también el MST para visualización
-std::vector<Producto> Grafo::resolverEnrutamientoConMST(std::vector<Arista>& mstResultado) {
-    if (productos.empty()) {
-        return std::vector<Producto>();
+void Grafo::insertarIncremental(int p) {
+    adyacenciaInc.resize(p + 1);
+    adyacenciaInc[p].clear();
+    viajeDe.push_back(-1);
+    marcaCamino.push_back(0);
+    padreCamino.push_back(-1);
+    
+    double x = coordenadas.x(p);
+    double y = coordenadas.y(p);
+    int octantes[RejillaEspacial::OCTANTES];
+    rejilla.masCercanosPorOctante(coordenadas, x, y, -1, octantes);
+    rejilla.insertar(p, x, y);
+    
+    std::vector<int>& candidatos = espacio().candidatos;
+    candidatos.clear();
+    for (int o = 0; o < RejillaEspacial::OCTANTES; o++) {
+        if (octantes[o] >= 0) candidatos.push_back(octantes[o]);
     }
+    std::sort(candidatos.begin(), candidatos.end(), PorDistanciaA(coordenadas, p));
     
-    // Paso 1: Construir matriz de adyacencia (grafo completo)
-    construirMatrizAdyacencia();
+    // Colgar p de su vecino más cercano y probar las demás aristas
+    if (!candidatos.empty()) {
+        adyacenciaInc[p].push_back(candidatos[0]);
+        adyacenciaInc[candidatos[0]].push_back(p);
+        for (size_t i = 1; i < candidatos.size(); i++) {
+            agregarAristaCiclo(p, candidatos[i]);
+        }
+    }
     
-    // Paso 2: Aplicar algoritmo de Prim para obtener MST
-    mstResultado = algoritmoPrim();
+    ubicarEnViaje(p, candidatos);
+    if (rejilla.desbalanceada()) rejilla.construir(coordenadas);
+}
+
+void Grafo::quitarIncremental(int p) {
+    std::vector<int>& vecinos = espacio().vecinosQuitado;
+    vecinos = adyacenciaInc[p];
+    for (size_t i = 0; i < vecinos.size(); i++) {
+        quitarVecino(adyacenciaInc[vecinos[i]], p);
+    }
+    adyacenciaInc[p].clear();
+    rejilla.quitar(p, coordenadas.x(p), coordenadas.y(p));
+    quitarDeViaje(p);
+    
+    // Cada ex vecino quedó en una parte distinta del árbol: Kruskal sobre
+    // los pares de ex vecinos los vuelve a unir sin recorrer las partes
+    int d = vecinos.size();
+    std::vector<Arista>& pares = espacio().reconexion;
+    pares.clear();
+    for (int i = 0; i < d; i++) {
+        for (int j = i + 1; j < d; j++) {
+            pares.push_back(Arista(i, j, coordenadas.distancia(vecinos[i], vecinos[j])));
+        }
+    }
+    std::sort(pares.begin(), pares.end());
     
-    // Paso 3: Construir listas de adyacencia del MST
-    construirMSTListasAdyacencia(mstResultado);
+    std::vector<int>& parte = espacio().parteReconexion;
+    parte.resize(d);
+    for (int i = 0; i < d; i++) {
+        parte[i] = i;
+    }
+    for (size_t i = 0; i < pares.size(); i++) {
+        int a = parte[pares[i].origen];
+        int b = parte[pares[i].destino];
+        if (a == b) continue;
+        for (int j = 0; j < d; j++) {
+            if (parte[j] == b) parte[j] = a;
+        }
+        int u = vecinos[pares[i].origen];
+        int v = vecinos[pares[i].destino];
+        adyacenciaInc[u].push_back(v);
+        adyacenciaInc[v].push_back(u);
+    }
     
-    // Paso 4: Realizar DFS sobre el MST para obtener orden de visita
-    std::vector<bool> visitadoDFS(productos.size(), false);
-    std::vector<int> ordenVisita;
+    // Aristas hacia los cercanos de cada ex vecino que quizás convenga más
+    int octantes[RejillaEspacial::OCTANTES];
+    for (int i = 0; i < d; i++) {
+        int u = vecinos[i];
+        rejilla.masCercanosPorOctante(coordenadas, coordenadas.x(u), coordenadas.y(u), u, octantes);
+        for (int o = 0; o < RejillaEspacial::OCTANTES; o++) {
+            if (octantes[o] >= 0) agregarAristaCiclo(u, octantes[o]);
+        }
+    }
+}
+
+void Grafo::renombrarIncremental(int ultimo, int indice) {
+    if (ultimo != indice) {
+        adyacenciaInc[indice].swap(adyacenciaInc[ultimo]);
+        for (size_t i = 0; i < adyacenciaInc[indice].size(); i++) {
+            std::vector<int>& lista = adyacenciaInc[adyacenciaInc[indice][i]];
+            std::replace(lista.begin(), lista.end(), ultimo, indice);
+        }
+        
+        int t = viajeDe[ultimo];
+        viajeDe[indice] = t;
+        if (t >= 0) std::replace(viajesInc[t].begin(), viajesInc[t].end(), ultimo, indice);
+        
+        rejilla.renombrar(ultimo, indice, coordenadas.x(ultimo), coordenadas.y(ultimo));
+    }
+    adyacenciaInc.pop_back();
+    viajeDe.pop_back();
+    marcaCamino.pop_back();
+    padreCamino.pop_back();
+}
+
+bool Grafo::caminoArbol(int a, int b, std::vector<int>& camino) {
+    camino.clear();
+    if (a == b) {
+        camino.push_back(a);
+        return true;
+    }
     
-    // Comenzar DFS desde el nodo más cercano a la base
-    int nodoInicial = nodoMasCercanoABase(visitadoDFS);
-    dfsRecorrido(nodoInicial, visitadoDFS, ordenVisita);
+    // Dos sellos por búsqueda, uno por extremo
+    selloCamino += 2;
+    if (selloCamino >= std::numeric_limits<int>::max() - 2) {
+        std::fill(marcaCamino.begin(), marcaCamino.end(), 0);
+        selloCamino = 2;
+    }
+    const int selloA = selloCamino;
+    const int selloB = selloCamino + 1;
     
-    // Paso 5: Construir ruta con restricción de capacidad
-    std::vector<Producto> rutaFinal;
-    int productosEnViaje = 0;
+    // BFS desde ambos extremos a la vez, avanzando siempre el que tiene
+    // menos nodos por expandir, hasta que los dos recorridos se tocan: en
+    // un árbol el camino es único y se recorre a lo sumo lo que cabe en dos
+    // radios de la mitad de su largo
+    std::vector<int>& colaA = espacio().colaCamino;
+    std::vector<int>& colaB = espacio().colaCaminoB;
+    colaA.assign(1, a);
+    colaB.assign(1, b);
+    marcaCamino[a] = selloA;
+    marcaCamino[b] = selloB;
+    padreCamino[a] = padreCamino[b] = -1;
+    size_t iA = 0, iB = 0;
+    int encuentroA = -1, encuentroB = -1;
     
-    for (size_t i = 0; i < ordenVisita.size(); i++) {
-        int idx = ordenVisita[i];
+    while (encuentroA < 0 && iA < colaA.size() && iB < colaB.size()) {
+        bool ladoA = colaA.size() - iA <= colaB.size() - iB;
+        std::vector<int>& cola = ladoA ? colaA : colaB;
+        int propio = ladoA ? selloA : selloB;
+        int otro = ladoA ? selloB : selloA;
+        int u = cola[ladoA ? iA++ : iB++];
         
-        // Si alcanzamos la capacidad, regresar a base
-        if (productosEnViaje == capacidad) {
-            rutaFinal.push_back(base);
-            productosEnViaje = 0;
+        for (size_t j = 0; j < adyacenciaInc[u].size(); j++) {
+            int w = adyacenciaInc[u][j];
+            if (marcaCamino[w] == otro) {
+                encuentroA = ladoA ? u : w;
+                encuentroB = ladoA ? w : u;
+                break;
+            }
+            if (marcaCamino[w] != propio) {
+                marcaCamino[w] = propio;
+                padreCamino[w] = u;
+                cola.push_back(w);
+            }
         }
+    }
+    if (encuentroA < 0) return false;
+    
+    // a ... encuentroA, encuentroB ... b
+    for (int v = encuentroA; v >= 0; v = padreCamino[v]) {
+        camino.push_back(v);
+    }
+    std::reverse(camino.begin(), camino.end());
+    for (int v = encuentroB; v >= 0; v = padreCamino[v]) {
+        camino.push_back(v);
+    }
+    return true;
+}
+
+void Grafo::agregarAristaCiclo(int a, int b) {
+    std::vector<int>& camino = espacio().camino;
+    if (!caminoArbol(a, b, camino)) {
+        // Partes distintas: la arista las une
+        adyacenciaInc[a].push_back(b);
+        adyacenciaInc[b].push_back(a);
+        return;
+    }
+    
+    double peso = coordenadas.distancia(a, b);
+    double maximo = peso;
+    int u = -1, v = -1;
+    for (size_t i = 0; i + 1 < camino.size(); i++) {
+        double w = coordenadas.distancia(camino[i], camino[i + 1]);
+        if (w > maximo) {
+            maximo = w;
+            u = camino[i];
+            v = camino[i + 1];
+        }
+    }
+    if (u < 0) return; // La arista nueva es la más pesada del ciclo
+    
+    quitarVecino(adyacenciaInc[u], v);
+    quitarVecino(adyacenciaInc[v], u);
+    adyacenciaInc[a].push_back(b);
+    adyacenciaInc[b].push_back(a);
+}
+
+double Grafo::costoInsercion(int t, int p, int& posicion) const {
+    const std::vector<int>& viaje = viajesInc[t];
+    int m = viaje.size();
+    double mejor = std::numeric_limits<double>::infinity();
+    posicion = 0;
+    for (int i = 0; i <= m; i++) {
+        int anterior = (i > 0) ? viaje[i - 1] : -1;
+        int siguiente = (i < m) ? viaje[i] : -1;
+        double delta = tramo(coordenadas, base, anterior, p) + tramo(coordenadas, base, p, siguiente)
+                     - tramo(coordenadas, base, anterior, siguiente);
+        if (delta < mejor) {
+            mejor = delta;
+            posicion = i;
+        }
+    }
+    return mejor;
+}
+
+double Grafo::costoParticion(int t, int& corte) const {
+    const std::vector<int>& viaje = viajesInc[t];
+    int m = viaje.size();
+    int k = std::max(capacidad, 1);
+    corte = m;
+    if (m <= k) return 0.0;
+    
+    // Volver a la base tras viaje[c - 1] y salir de nuevo hacia viaje[c]
+    double mejor = std::numeric_limits<double>::infinity();
+    for (int c = std::max(1, m - k); c <= std::min(k, m - 1); c++) {
+        double delta = tramo(coordenadas, base, viaje[c - 1], -1) + tramo(coordenadas, base, -1, viaje[c])
+                     - tramo(coordenadas, base, viaje[c - 1], viaje[c]);
+        if (delta < mejor) {
+            mejor = delta;
+            corte = c;
+        }
+    }
+    return mejor;
+}
+
+void Grafo::ubicarEnViaje(int p, const std::vector<int>& candidatos) {
+    int k = std::max(capacidad, 1);
+    
+    // Viaje con lugar libre entre los de los vecinos de p
+    double mejorCosto = std::numeric_limits<double>::infinity();
+    int mejorViaje = -1, mejorPosicion = 0;
+    for (size_t i = 0; i < candidatos.size(); i++) {
+        int t = viajeDe[candidatos[i]];
+        if (t < 0 || (int)viajesInc[t].size() >= k) continue;
+        int posicion;
+        double costo = costoInsercion(t, p, posicion);
+        if (costo < mejorCosto) {
+            mejorCosto = costo;
+            mejorViaje = t;
+            mejorPosicion = posicion;
+        }
+    }
+    if (mejorViaje >= 0) {
+        viajesInc[mejorViaje].insert(viajesInc[mejorViaje].begin() + mejorPosicion, p);
+        viajeDe[p] = mejorViaje;
+        return;
+    }
+    
+    // Todos llenos: se inserta p en uno de esos viajes y se lo parte en
+    // dos, o se pasa uno de sus productos a un viaje con lugar de algún
+    // vecino suyo en el árbol; o bien p sale en un viaje propio
+    double mejor = 2.0 * tramo(coordenadas, base, -1, p);
+    int viaje = -1, posicion = 0, corte = -1, expulsado = -1, destino = -1, posDestino = 0;
+    for (size_t i = 0; i < candidatos.size(); i++) {
+        int t = viajeDe[candidatos[i]];
+        bool repetido = false;
+        for (size_t j = 0; j < i && !repetido; j++) {
+            repetido = viajeDe[candidatos[j]] == t;
+        }
+        if (repetido) continue;
         
-        // Agregar producto a la ruta
-        rutaFinal.push_back(productos[idx]);
-        productosEnViaje++;
+        int pos;
+        double costo = costoInsercion(t, p, pos);
+        viajesInc[t].insert(viajesInc[t].begin() + pos, p);
+        
+        int c, q, u, posU;
+        double particion = costo + costoParticion(t, c);
+        double expulsion = costo + costoExpulsion(t, p, q, u, posU);
+        if (particion < mejor) {
+            mejor = particion;
+            viaje = t;
+            posicion = pos;
+            corte = c;
+            expulsado = -1;
+        }
+        if (expulsion < mejor) {
+            mejor = expulsion;
+            viaje = t;
+            posicion = pos;
+            expulsado = q;
+            destino = u;
+            posDestino = posU;
+        }
+        viajesInc[t].erase(viajesInc[t].begin() + pos);
+    }
+    
+    if (viaje < 0) {
+        viajeDe[p] = viajesInc.size();
+        viajesInc.push_back(std::vector<int>(1, p));
+        return;
     }
     
-    // Regreso final a la base
-    rutaFinal.push_back(base);
+    std::vector<int>& lista = viajesInc[viaje];
+    lista.insert(lista.begin() + posicion, p);
+    viajeDe[p] = viaje;
+    if (expulsado >= 0) {
+        lista.erase(std::find(lista.begin(), lista.end(), expulsado));
+        viajesInc[destino].insert(viajesInc[destino].begin() + posDestino, expulsado);
+        viajeDe[expulsado] = destino;
+    } else {
+        int nuevo = viajesInc.size();
+        viajesInc.push_back(std::vector<int>(lista.begin() + corte, lista.end()));
+        viajesInc[viaje].resize(corte);
+        for (size_t i = 0; i < viajesInc[nuevo].size(); i++) {
+            viajeDe[viajesInc[nuevo][i]] = nuevo;
+        }
+    }
+}
+
+double Grafo::costoExpulsion(int t, int p, int& expulsado, int& destino, int& posicion) const {
+    const std::vector<int>& viaje = viajesInc[t];
+    int m = viaje.size();
+    int k = std::max(capacidad, 1);
+    double mejor = std::numeric_limits<double>::infinity();
+    expulsado = destino = -1;
+    posicion = 0;
+    
+    for (int i = 0; i < m; i++) {
+        int q = viaje[i];
+        if (q == p) continue;
+        int anterior = (i > 0) ? viaje[i - 1] : -1;
+        int siguiente = (i + 1 < m) ? viaje[i + 1] : -1;
+        double ahorro = tramo(coordenadas, base, anterior, q) + tramo(coordenadas, base, q, siguiente)
+                      - tramo(coordenadas, base, anterior, siguiente);
+        
+        // Viajes con lugar de los vecinos de q en el árbol
+        for (size_t j = 0; j < adyacenciaInc[q].size(); j++) {
+            int u = viajeDe[adyacenciaInc[q][j]];
+            if (u < 0 || u == t || (int)viajesInc[u].size() >= k) continue;
+            int pos;
+            double costo = costoInsercion(u, q, pos) - ahorro;
+            if (costo < mejor) {
+                mejor = costo;
+                expulsado = q;
+                destino = u;
+                posicion = pos;
+            }
+        }
+    }
+    return mejor;
+}
+
+void Grafo::quitarDeViaje(int p) {
+    int t = viajeDe[p];
+    if (t < 0) return;
+    std::vector<int>& viaje = viajesInc[t];
+    viaje.erase(std::find(viaje.begin(), viaje.end(), p));
+    viajeDe[p] = -1;
     
-    return resolverEnrutamientoVecinoMasCercano();
+    // Un viaje vacío se reemplaza por el último
+    if (viaje.empty()) {
+        int ultimo = (int)viajesInc.size() - 1;
+        if (t != ultimo) {
+            viajesInc[t].swap(viajesInc[ultimo]);
+            for (size_t i = 0; i < viajesInc[t].size(); i++) {
+                viajeDe[viajesInc[t][i]] = t;
+            }
+        }
+        viajesInc.pop_back();
+    }
+}
+
+std::vector<Producto> Grafo::resolverEnrutamiento() {
+    return obtenerRuta().comoProductos(coordenadas);
+}
+
+std::vector<Producto> Grafo::resolverEnrutamientoVecinoMasCercano() {
+    return obtenerRuta().comoProductos(coordenadas);
+}
+
+// Versión que retorna también el MST para visualización
+std::vector<Producto> Grafo::resolverEnrutamientoConMST(std::vector<Arista>& mstResultado) {
+    // MST y ruta salen de la misma cache: el árbol no se construye dos veces
+    mstResultado = obtenerMST();
+    return obtenerRuta().comoProductos(coordenadas);
 }
 
 double Grafo::calcularDistanciaTotal(const std::vector<Producto>& ruta) {
@@ -266,10 +1269,72 @@ double Grafo::calcularDistanciaTotal(const std::vector<Producto>& ruta) {
     return distanciaTotal;
 }
 
+double Grafo::calcularDistanciaTotal(const Ruta& ruta) const {
+    if (bodega != 0 && distancias.getModo() == DISTANCIAS_BODEGA &&
+        distancias.preparadoPara(coordenadas)) {
+        return medirRutaBodega(ruta, 0);
+    }
+    return ruta.medirDistancias(coordenadas);
+}
+
+double Grafo::distanciaTramo(int desde, int hasta) {
+    if (desde == hasta) return 0.0;
+    if (bodega != 0) {
+        // Una ruta de la cache no preparó la tabla de la bodega
+        prepararDistancias();
+        if (desde < 0) return distancias.distanciaBase(hasta);
+        if (hasta < 0) return distancias.distanciaBase(desde);
+        return distancias.distancia(desde, hasta);
+    }
+    if (desde < 0) return coordenadas.distanciaA(hasta, base.x, base.y);
+    if (hasta < 0) return coordenadas.distanciaA(desde, base.x, base.y);
+    return coordenadas.distancia(desde, hasta);
+}
+
+double Grafo::medirRutaBodega(const Ruta& ruta, std::vector<double>* porViaje) const {
+    // Mismo recorrido que Ruta::medirDistancias, con la tabla de la bodega
+    double total = 0.0;
+    if (porViaje != 0) porViaje->assign(ruta.numViajes(), 0.0);
+    
+    for (int t = 0; t < ruta.numViajes(); t++) {
+        double viaje = 0.0;
+        int anterior = -1;
+        for (int p = ruta.inicioViaje[t]; p < ruta.inicioViaje[t + 1]; p++) {
+            int actual = ruta.indices[p];
+            double tramo = (anterior < 0) ? distancias.distanciaBase(actual)
+                                          : distancias.distancia(anterior, actual);
+            viaje += tramo;
+            total += tramo;
+            anterior = actual;
+        }
+        if (anterior >= 0) {
+            double tramo = distancias.distanciaBase(anterior);
+            viaje += tramo;
+            total += tramo;
+        }
+        if (porViaje != 0) (*porViaje)[t] = viaje;
+    }
+    return total;
+}
+
 void Grafo::limpiar() {
-    productos.clear();
-    matrizAdyacencia.clear();
-    listasAdyacencia.clear();
+    coordenadas.clear();
+    distancias.reiniciar();
+    inicioVecinos.clear();
+    vecinosArbol.clear();
+    preorden.clear();
+    posPreorden.clear();
+    finSubarbol.clear();
+    padreArbol.clear();
+    indiceEspacial.limpiar();
+    mstCache.clear();
+    rutaCache.limpiar(base);
+    rejilla.limpiar();
+    adyacenciaInc.clear();
+    viajesInc.clear();
+    viajeDe.clear();
+    incrementalListo = false;
+    invalidarEtapas();
 }
 
 void Grafo::mostrarMST(const std::vector<Arista>& mst) {
@@ -288,20 +1353,18 @@ void Grafo::mostrarMST(const std::vector<Arista>& mst) {
 }
 
 void Grafo::mostrarMatrizDistancias() {
-    int n = productos.size();
+    int n = coordenadas.size();
     if (n == 0) {
         std::cout << "No hay productos en el grafo." << std::endl;
         return;
     }
     
-    // Verificar que la matriz esté construida
-    if (matrizAdyacencia.empty() || matrizAdyacencia.size() != (size_t)n) {
-        std::cout << "Construyendo matriz de adyacencia..." << std::endl;
-        construirMatrizAdyacencia();
-    }
+    // Verificar que las distancias estén preparadas
+    prepararDistancias();
     
     std::cout << "\n=== MATRIZ DE DISTANCIAS (Grafo Completo) ===" << std::endl;
-    std::cout << "Distancias euclidianas entre todos los productos:\n" << std::endl;
+    std::cout << "Distancias " << (bodega != 0 ? "por los pasillos" : Metrica::nombre())
+              << " entre todos los productos:\n" << std::endl;
     
     // Encabezado
     std::cout << "      ";
@@ -324,7 +1387,7 @@ void Grafo::mostrarMatrizDistancias() {
                 std::cout << "   -   ";
             } else {
                 std::cout << std::fixed << std::setprecision(2) 
-                         << std::setw(6) << matrizAdyacencia[i][j] << " ";
+                         << std::setw(6) << distancias.distancia(i, j) << " ";
             }
         }
         std::cout << std::endl;
@@ -334,7 +1397,8 @@ void Grafo::mostrarMatrizDistancias() {
     for (int i = 0; i < n; i++) {
         std::cout << "  BASE -> P" << (i+1) << ": " 
                   << std::fixed << std::setprecision(2) 
-                  << base.distanciaA(productos[i]) << " m" << std::endl;
+                  << (bodega != 0 ? distancias.distanciaBase(i) : base.distanciaA(coordenadas.producto(i)))
+                  << " m" << std::endl;
     }
     std::cout << "=============================================\n" << std::endl;
 }
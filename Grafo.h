@@ -6,70 +6,245 @@
 #include <limits>
 #include <algorithm>
 #include <queue>
+#include "Coordenadas.h"
+#include "Arista.h"
+#include "Distancias.h"
+#include "ArbolKD.h"
+#include "MST.h"
+#include "MejoraLocal.h"
+#include "Ruteo.h"
+#include "Ruta.h"
+#include "EspacioTrabajo.h"
+#include "RejillaEspacial.h"
+#include "Instrumentacion.h"
+#include "CacheRutas.h"
 
-// Estructura para representar un producto con sus coordenadas
-struct Producto {
-    double x;
-    double y;
-    int id;
-    bool visitado;
-    
-    Producto(double x_ = 0, double y_ = 0, int id_ = -1) 
-        : x(x_), y(y_), id(id_), visitado(false) {}
-    
-    // Calcula distancia euclidiana a otro producto
-    double distanciaA(const Producto& otro) const {
-        double dx = x - otro.x;
-        double dy = y - otro.y;
-        return std::sqrt(dx * dx + dy * dy);
-    }
-};
+class PoolHilos;
 
-// Estructura para representar una arista en el grafo
-struct Arista {
-    int origen;
-    int destino;
-    double peso;
-    
-    Arista(int o, int d, double p) : origen(o), destino(d), peso(p) {}
+// Resultado de la última resolución con plazo (Grafo::setPlazo)
+struct ResultadoPlazo {
+    MotorRuteo motor;          // Motor que armó la ruta devuelta
+    int motoresProbados;       // Rutas completas construidas (barrido incluido)
+    double distanciaInicial;   // Distancia de la primera ruta válida (barrido)
+    double distancia;          // Distancia de la ruta devuelta
+    double primeraRutaMs;      // Tiempo hasta tener la primera ruta válida
+    double tiempoMs;           // Tiempo total de la resolución
+    bool plazoCumplido;
     
-    // Para usar en priority_queue (menor peso = mayor prioridad)
-    bool operator>(const Arista& otra) const {
-        return peso > otra.peso;
-    }
+    ResultadoPlazo() : motor(RUTEO_BARRIDO), motoresProbados(0), distanciaInicial(0),
+                       distancia(0), primeraRutaMs(0), tiempoMs(0), plazoCumplido(true) {}
 };
 
 // Clase Grafo que representa la bodega y los productos
 class Grafo {
 private:
-    std::vector<Producto> productos;
-    std::vector<std::vector<double>> matrizAdyacencia;
-    std::vector<std::vector<int>> listasAdyacencia; // Para el MST
+    Coordenadas coordenadas; // Estructura de arreglos (Coordenadas.h)
+    ProveedorDistancias distancias; // Distancias al vuelo o cache triangular
+    ModoDistancias modoDistancias;
+    const Bodega* bodega; // Plano con obstáculos (0 = distancias en línea recta)
+    MotorMST motorMST;
+    int hilosMST; // Hilos del Borůvka paralelo (1 = secuencial)
+    PoolHilos* poolMST; // Pool persistente para ese Borůvka (0 = uno por cálculo)
+    std::vector<int> inicioVecinos; // MST en formato CSR: n+1 desplazamientos
+    std::vector<int> vecinosArbol;  // Vecinos de cada nodo, contiguos
     Producto base; // Base en (0,0)
     int capacidad; // Capacidad máxima k
     
-    // Construye la matriz de adyacencia con todas las distancias
-    void construirMatrizAdyacencia();
+    // Resultados cacheados de cada etapa del resolvedor
+    std::vector<Arista> mstCache;
+    Ruta rutaCache;
+    bool mstValido;
+    bool arbolValido;
+    bool rutaValida;
+    
+    // Rutas de escenarios ya resueltos, compartida con otros grafos (0 = sin cache)
+    CacheRutas* cacheEscenarios;
+    bool rutaDesdeCache; // La ruta actual salió de cacheEscenarios
+    
+    // Recorrido del MST enraizado en el producto más cercano a la base:
+    // el subárbol de v ocupa las posiciones [posPreorden[v], finSubarbol[v])
+    std::vector<int> preorden;
+    std::vector<int> posPreorden;
+    std::vector<int> finSubarbol;
+    std::vector<int> padreArbol; // -1 en la raíz
+    
+    // Índice espacial de los productos (árbol kd con marcas de recogidos)
+    ArbolKD indiceEspacial;
+    bool indiceValido;
+    
+    // Construye el índice espacial si no está al día
+    void prepararIndiceEspacial();
+    
+    // Marca todas las etapas como pendientes de recalcular
+    void invalidarEtapas();
+    
+    // Etapa: listas de adyacencia y preorden del MST (calcula el MST si hace falta)
+    void prepararArbolMST();
+    
+    // Calcula preorden, rangos de subárbol y padres a partir de las listas
+    void calcularPreorden();
+    
+    // Etapa: arma los viajes sobre el árbol y deja la ruta en rutaCache
+    void extraerViajes();
+    
+    // Etapa opcional: búsqueda local sobre los viajes de rutaCache
+    void mejorarRuta();
+    
+    // Tiempo asignado a la mejora local (0 = desactivada)
+    double presupuestoMejoraMs;
+    ResultadoMejora resultadoMejora;
+    
+    // Motor que arma los viajes (por defecto el preorden del MST)
+    MotorRuteo motorRuteo;
+    
+    // Plazo por resolución en milisegundos (0 = sin plazo)
+    double plazoMs;
+    ResultadoPlazo resultadoPlazo;
+    
+    // Porcentaje del plazo que la mejora local deja sin usar
+    static const int MARGEN_PLAZO_PORCIENTO = 5;
+    
+    // Con plazo, el MST usa Prim denso hasta este tamaño y Borůvka después
+    static const int UMBRAL_PLAZO_PRIM_DENSO = 1000;
+    
+    // Etapa con plazo: barrido, luego los motores que se estima que caben
+    // en el tiempo restante, y la mejora local hasta el plazo; deja en
+    // rutaCache la mejor ruta
+    void resolverConPlazoInterno();
+    
+    // Copia los viajes de rutaCache como listas sueltas
+    void separarViajes(std::vector<std::vector<int> >& viajes) const;
+    
+    // Memoria de trabajo: la propia o la ligada con usarEspacioTrabajo
+    EspacioTrabajo espacioPropio;
+    EspacioTrabajo* espacioExterno;
+    EspacioTrabajo& espacio() { return espacioExterno != 0 ? *espacioExterno : espacioPropio; }
+    
+    // Modo incremental (setModoIncremental): tras la primera resolución el
+    // MST y los viajes se mantienen con cambios locales en lugar de
+    // recalcularse al agregar o eliminar productos
+    bool modoIncremental;
+    bool incrementalListo; // Estado incremental sincronizado con los productos
+    RejillaEspacial rejilla; // Índice espacial dinámico de los productos
+    std::vector<std::vector<int> > adyacenciaInc; // MST como listas mutables
+    std::vector<std::vector<int> > viajesInc;     // Viajes en orden de visita
+    std::vector<int> viajeDe;                     // Viaje de cada producto
+    std::vector<int> marcaCamino; // Búsqueda de caminos en el árbol: sello
+    std::vector<int> padreCamino; // de visita y predecesor de cada nodo
+    int selloCamino;
+    
+    // Arma el estado incremental a partir del MST y la ruta ya calculados
+    void iniciarIncremental();
+    
+    // Conecta el producto p (recién agregado) al árbol y a un viaje
+    void insertarIncremental(int p);
+    
+    // Desconecta el producto p del árbol y de su viaje y reconecta el árbol
+    void quitarIncremental(int p);
+    
+    // El producto ultimo pasa a llamarse indice (tras quitar el anterior indice)
+    void renombrarIncremental(int ultimo, int indice);
+    
+    // Propiedad del ciclo: agrega la arista (a, b) al árbol y quita la más
+    // pesada del ciclo que se forma (la nueva misma si es la más pesada)
+    void agregarAristaCiclo(int a, int b);
+    
+    // Camino de a hasta b en el árbol incremental (a, ..., b en camino);
+    // false si están en partes distintas
+    bool caminoArbol(int a, int b, std::vector<int>& camino);
+    
+    // Inserta p en el viaje más barato entre los de sus vecinos; si todos
+    // están llenos, lo inserta igual y parte ese viaje en dos o pasa otro
+    // producto a un viaje con lugar, o le abre un viaje propio, lo más corto
+    void ubicarEnViaje(int p, const std::vector<int>& candidatos);
+    
+    // Aumento de distancia al insertar p en la mejor posición del viaje t
+    double costoInsercion(int t, int p, int& posicion) const;
+    
+    // Mejor corte de un viaje que superó la capacidad en dos viajes válidos:
+    // devuelve el aumento de distancia y deja en corte la primera posición
+    // del segundo viaje
+    double costoParticion(int t, int& corte) const;
+    
+    // Mejor producto del viaje t (salvo p) para pasar a un viaje con lugar
+    // de alguno de sus vecinos en el árbol: devuelve el aumento de distancia
+    // (infinito si no hay) y deja en destino y posicion dónde insertarlo
+    double costoExpulsion(int t, int p, int& expulsado, int& destino, int& posicion) const;
+    
+    // Quita p de su viaje (elimina el viaje si queda vacío)
+    void quitarDeViaje(int p);
+    
+    // Instrumentación del último cálculo (en 0 sin INSTRUMENTACION)
+    TiemposEtapas tiempos;
+    ContadoresGrafo contadores;
+    
+    // Vecinos más cercanos usados por la mejora local y por los ahorros
+    static const int VECINOS_MEJORA = 8;
+    static const int VECINOS_AHORROS = 16;
+    
+    // Llena vecinos con numVecinos vecinos por producto (-1 si faltan) y
+    // devuelve la cantidad efectiva de vecinos por producto
+    int calcularListasVecinos(int numVecinos, std::vector<int>& vecinos);
+    
+    // Reemplaza rutaCache por los viajes dados (los vacíos se omiten)
+    void armarRuta(const std::vector<std::vector<int> >& viajes);
+    
+    // Prepara el proveedor de distancias para los productos actuales
+    void prepararDistancias();
     
     // Algoritmo de Prim para construir MST
-    std::vector<Arista> algoritmoPrim();
+    void algoritmoPrim(std::vector<Arista>& mst);
+    
+    // Prim O(n²) con arreglos de distancia mínima sobre el proveedor de
+    // distancias (el MST con bodega, donde no sirve la geometría)
+    void algoritmoPrimTabla(std::vector<Arista>& mst);
+    
+    // Distancia de una ruta por los pasillos de la bodega; si porViaje no
+    // es nulo deja ahí la de cada viaje
+    double medirRutaBodega(const Ruta& ruta, std::vector<double>* porViaje) const;
+    
+    // Construye el MST con el motor seleccionado
+    void calcularMST(std::vector<Arista>& mst);
     
     // Construye listas de adyacencia del MST
     void construirMSTListasAdyacencia(const std::vector<Arista>& mst);
     
-    // DFS para recorrer el MST
-    void dfsRecorrido(int nodo, std::vector<bool>& visitado, std::vector<int>& recorrido);
+    // DFS iterativo para recorrer el MST
+    void dfsRecorrido(int nodo, std::vector<char>& visitado, std::vector<int>& recorrido);
     
-    // Encuentra el nodo más cercano a la base no visitado
-    int nodoMasCercanoABase(const std::vector<bool>& visitado);
+    // Encuentra el producto sin marcar más cercano a la base (vía el índice)
+    int nodoMasCercanoABase();
     
 public:
     // Constructor
     Grafo(int k);
     
+    // Cambia la capacidad k (para reutilizar el grafo entre escenarios)
+    void setCapacidad(int k);
+    
+    // Reserva espacio para m productos (una sola asignación por escenario)
+    void reservarProductos(int m) { coordenadas.reserve(m); }
+    
+    // Usa la memoria de trabajo dada en lugar de la propia (0 vuelve a la
+    // propia); el espacio debe sobrevivir al grafo y no usarse en otro hilo
+    void usarEspacioTrabajo(EspacioTrabajo* espacio) { espacioExterno = espacio; }
+    
     // Agrega un producto al grafo
     void agregarProducto(double x, double y);
     
+    // Elimina el producto indicado; el último producto pasa a ocupar su
+    // índice (las Rutas obtenidas antes quedan desactualizadas). Devuelve
+    // false si el índice no existe.
+    bool eliminarProducto(int indice);
+    
+    // Modo incremental para turnos con pedidos que llegan y se cancelan:
+    // tras la primera resolución completa, agregarProducto y
+    // eliminarProducto actualizan el MST localmente (candidatos por octante
+    // en una rejilla dinámica y reemplazo por la propiedad del ciclo) y
+    // replanifican solo los viajes afectados. Cambiar capacidad, motores o
+    // mejora vuelve a resolver desde cero en la siguiente consulta.
+    void setModoIncremental(bool activo);
+    
     // Resuelve el problema de enrutamiento usando Prim + DFS
     std::vector<Producto> resolverEnrutamiento();
     
@@ -78,13 +253,102 @@ public:
 
     std::vector<Producto> resolverEnrutamientoVecinoMasCercano();
     
-    // Calcula la distancia total de una ruta
+    // Calcula la distancia total de una ruta dada como lista de paradas
     double calcularDistanciaTotal(const std::vector<Producto>& ruta);
     
+    // Calcula la distancia total de una ruta de índices del escenario actual
+    double calcularDistanciaTotal(const Ruta& ruta) const;
+    
+    // Distancia de un tramo de la ruta entre dos productos del escenario
+    // actual (-1 es la base): por los pasillos con bodega, como la
+    // distancia de la ruta, y en línea recta si no
+    double distanciaTramo(int desde, int hasta);
+    
+    // Los k productos más cercanos al producto indicado (sin incluirlo),
+    // de menor a mayor distancia
+    void vecinosMasCercanos(int indice, int k, std::vector<int>& resultado);
+    
     // Obtiene el número de productos
-    int getNumProductos() const { return productos.size(); }
+    int getNumProductos() const { return coordenadas.size(); }
+    
+    // Selecciona cómo se obtienen las distancias (por defecto automático)
+    void setModoDistancias(ModoDistancias modo);
+    
+    // Mide las distancias por los pasillos de la bodega dada en lugar de en
+    // línea recta (0 vuelve a la línea recta). Todos los productos deben
+    // estar en ubicaciones de la bodega (Bodega::ubicacionEn), que debe
+    // sobrevivir al grafo. Con bodega el MST sale de Prim sobre su tabla,
+    // los viajes del preorden del MST (semillas por camino a la base) y la
+    // distancia de la ruta es la recorrida por los pasillos; el motor de
+    // ruteo, la mejora local, el plazo y el modo incremental razonan en
+    // línea recta y no se aplican.
+    void usarBodega(const Bodega* plano);
+    const Bodega* getBodega() const { return bodega; }
     
-    // Limpia el grafo para un nuevo escenario
+    // Consulta la cache antes de resolver y guarda en ella cada ruta
+    // resuelta (0 la desactiva). Todos los grafos que la comparten deben
+    // estar configurados igual (ver CacheRutas.h); la cache debe sobrevivir
+    // al grafo. En modo incremental no se usa.
+    void usarCacheRutas(CacheRutas* cache) { cacheEscenarios = cache; }
+    
+    // La última ruta obtenida salió de la cache sin resolver el escenario
+    // (el MST, la mejora y el plazo no corresponden a esa ruta)
+    bool rutaDeCache() const { return rutaDesdeCache; }
+    
+    // Selecciona el motor de ruteo: MST, ahorros o barrido
+    void setMotorRuteo(MotorRuteo motor);
+    
+    // Selecciona el motor del MST (por defecto automático)
+    void setMotorMST(MotorMST motor);
+    
+    // Hilos con los que Borůvka construye el MST de los escenarios grandes
+    // (1 = secuencial, por defecto; 0 = todos los núcleos). El árbol es el
+    // mismo con cualquier número de hilos.
+    void setHilosMST(int numHilos) { hilosMST = numHilos; }
+    
+    // Usa un pool de hilos ya creado para el Borůvka paralelo en lugar de
+    // crear uno en cada cálculo (0 vuelve a eso). No debe ser el pool que
+    // está ejecutando a este grafo.
+    void usarPoolMST(PoolHilos* pool) { poolMST = pool; }
+    
+    // Activa la mejora local (2-opt, Or-opt, reubicar/intercambiar entre
+    // viajes) con un presupuesto de tiempo en milisegundos; 0 la desactiva
+    void setPresupuestoMejora(double ms);
+    
+    // Resolución "anytime" con plazo en milisegundos (0 la desactiva):
+    // obtenerRuta arma primero una ruta válida por barrido y con el tiempo
+    // que queda prueba el preorden del MST y los ahorros (si se estima que
+    // terminan antes del plazo), se queda con la más corta y la mejora
+    // localmente hasta el plazo. Con plazo se ignoran el motor de ruteo y
+    // el presupuesto de mejora. La ruta es válida aunque el plazo no
+    // alcance ni para el barrido (ver getResultadoPlazo).
+    void setPlazo(double ms);
+    
+    // Atajo: fija el plazo y resuelve
+    const Ruta& resolverConPlazo(double ms) {
+        setPlazo(ms);
+        return obtenerRuta();
+    }
+    
+    // Motor elegido, distancias y tiempos de la última resolución con plazo
+    const ResultadoPlazo& getResultadoPlazo() const { return resultadoPlazo; }
+    
+    // Distancias antes/después y tiempo de la última mejora local
+    const ResultadoMejora& getResultadoMejora() const { return resultadoMejora; }
+    
+    // Tiempos por etapa y contadores del escenario actual (requieren
+    // compilar con INSTRUMENTACION)
+    const TiemposEtapas& getTiemposEtapas() const { return tiempos; }
+    const ContadoresGrafo& getContadores() const { return contadores; }
+    
+    // MST del escenario actual (se calcula solo la primera vez)
+    const std::vector<Arista>& obtenerMST();
+    
+    // Ruta del escenario actual (reutiliza MST y árbol ya calculados), con
+    // la distancia y la carga de cada viaje
+    const Ruta& obtenerRuta();
+    
+    // Limpia el grafo para un nuevo escenario (conserva la memoria reservada)
     void limpiar();
     
     // Muestra información del MST (para depuración)
@@ -94,7 +358,10 @@ public:
     void mostrarMatrizDistancias();
     
     // Obtiene un producto por índice
-    Producto getProducto(int index) const { return productos[index]; }
+    Producto getProducto(int index) const { return coordenadas.producto(index); }
+    
+    // Coordenadas del escenario actual (las referencian los índices de Ruta)
+    const Coordenadas& getCoordenadas() const { return coordenadas; }
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,72 @@
+#ifndef INSTRUMENTACION_H
+#define INSTRUMENTACION_H
+
+#include <chrono>
+
+// Instrumentación del resolvedor: temporizadores por etapa y contadores de
+// operaciones. Solo se compila con -DINSTRUMENTACION (make INSTRUMENTACION=1);
+// sin esa bandera las macros no generan código y los valores quedan en 0.
+
+#ifdef INSTRUMENTACION
+#define INSTRUMENTAR(sentencia) sentencia
+#else
+#define INSTRUMENTAR(sentencia)
+#endif
+
+#define CONCATENAR_INTERNO(a, b) a##b
+#define CONCATENAR(a, b) CONCATENAR_INTERNO(a, b)
+
+// Mide el tiempo hasta el final del bloque actual y lo guarda (en ms) en destino
+#define MEDIR_ETAPA(destino) \
+    INSTRUMENTAR(TemporizadorEtapa CONCATENAR(temporizador_, __LINE__)(destino))
+
+// Suma n al contador dado
+#define CONTAR(contador, n) INSTRUMENTAR((contador) += (n))
+
+// Guarda en destino los milisegundos transcurridos durante su vida
+class TemporizadorEtapa {
+public:
+    explicit TemporizadorEtapa(double& d) : destino(d), inicio(std::chrono::steady_clock::now()) {}
+    ~TemporizadorEtapa() {
+        destino = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - inicio).count();
+    }
+    
+private:
+    double& destino;
+    std::chrono::steady_clock::time_point inicio;
+    
+    TemporizadorEtapa(const TemporizadorEtapa&);
+    TemporizadorEtapa& operator=(const TemporizadorEtapa&);
+};
+
+// Tiempo en milisegundos de cada etapa del último cálculo de un Grafo (0 si
+// la etapa no se ejecutó, por ejemplo el recorrido del MST con otros motores)
+struct TiemposEtapas {
+    double indice;      // Construcción del árbol kd
+    double distancias;  // Preparación del proveedor de distancias
+    double mst;         // Algoritmo del MST
+    double recorrido;   // Listas de adyacencia y preorden del MST
+    double viajes;      // Armado de los viajes
+    double mejora;      // Mejora local
+    
+    TiemposEtapas() : indice(0), distancias(0), mst(0), recorrido(0), viajes(0), mejora(0) {}
+    
+    double total() const { return indice + distancias + mst + recorrido + viajes + mejora; }
+};
+
+// Contadores de operaciones del último cálculo de un Grafo
+struct ContadoresGrafo {
+    unsigned long long evaluacionesDistancia; // Distancias entre productos calculadas o leídas
+    unsigned long long insercionesHeap;       // push en la cola de algoritmoPrim
+    unsigned long long extraccionesHeap;      // pop en la cola de algoritmoPrim
+    unsigned long long visitasDFS;            // Nodos visitados por dfsRecorrido
+    unsigned long long consultasIndice;       // Búsquedas en el árbol kd
+    unsigned long long viajes;                // Viajes de la ruta producida
+    
+    ContadoresGrafo()
+        : evaluacionesDistancia(0), insercionesHeap(0), extraccionesHeap(0),
+          visitasDFS(0), consultasIndice(0), viajes(0) {}
+};
+
+#endif
@@ -0,0 +1,285 @@
+#include "LectorEscenarios.h"
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace {
+
+bool esEspacio(char c) {
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t' || c == '\v' || c == '\f';
+}
+
+bool esDigito(char c) {
+    return c >= '0' && c <= '9';
+}
+
+// Potencias de 10 exactas en double (hasta 10^22)
+const double POTENCIAS_10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+// Conversión rápida de decimales simples: si la mantisa cabe exacta en un
+// double (< 2^53) y |exponente| <= 22, una sola multiplicación o división
+// da el resultado correctamente redondeado. Devuelve false si el token no
+// es de esa forma (entonces se usa strtod).
+bool convertirRapido(const char* p, const char* fin, double& valor) {
+    bool negativo = false;
+    if (p < fin && (*p == '-' || *p == '+')) {
+        negativo = (*p == '-');
+        p++;
+    }
+    
+    unsigned long long mantisa = 0;
+    int digitos = 0;
+    int exponente = 0;
+    bool hayDigitos = false;
+    
+    while (p < fin && esDigito(*p)) {
+        if (digitos < 19) {
+            mantisa = mantisa * 10 + (*p - '0');
+            if (mantisa != 0) digitos++;
+        } else {
+            return false;
+        }
+        hayDigitos = true;
+        p++;
+    }
+    if (p < fin && *p == '.') {
+        p++;
+        while (p < fin && esDigito(*p)) {
+            if (digitos >= 19) return false;
+            mantisa = mantisa * 10 + (*p - '0');
+            if (mantisa != 0) digitos++;
+            exponente--;
+            hayDigitos = true;
+            p++;
+        }
+    }
+    if (!hayDigitos || p != fin) return false; // Exponentes y otros casos
+    if (mantisa >= (1ULL << 53) || exponente < -22) return false;
+    
+    valor = (double)mantisa / POTENCIAS_10[-exponente];
+    if (negativo) valor = -valor;
+    return true;
+}
+
+}
+
+LectorEscenarios::LectorEscenarios()
+    : inicio(0), fin(0), cursor(0), linea(1), proyeccion(0), tamanoProyeccion(0), descriptor(-1) {}
+
+LectorEscenarios::~LectorEscenarios() {
+    cerrar();
+}
+
+bool LectorEscenarios::abrir(const std::string& archivo) {
+    cerrar();
+    
+    int fd = open(archivo.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    
+    struct stat info;
+    if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+        void* datos = mmap(0, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (datos != MAP_FAILED) {
+            madvise(datos, info.st_size, MADV_SEQUENTIAL);
+            proyeccion = datos;
+            tamanoProyeccion = info.st_size;
+            inicio = static_cast<const char*>(datos);
+            fin = inicio + info.st_size;
+        }
+    }
+    close(fd);
+    
+    // Archivos vacíos, tuberías, etc.: leer a un buffer
+    if (proyeccion == 0) {
+        std::ifstream entrada(archivo.c_str(), std::ios::binary);
+        if (!entrada.is_open()) return false;
+        buffer.assign(std::istreambuf_iterator<char>(entrada), std::istreambuf_iterator<char>());
+        inicio = buffer.empty() ? 0 : &buffer[0];
+        fin = inicio + buffer.size();
+    }
+    
+    cursor = inicio;
+    linea = 1;
+    error.clear();
+    return true;
+}
+
+void LectorEscenarios::abrirDescriptor(int fd) {
+    cerrar();
+    descriptor = fd;
+    buffer.resize(TAMANO_LECTURA);
+    inicio = fin = cursor = &buffer[0];
+    linea = 1;
+    error.clear();
+}
+
+bool LectorEscenarios::rellenar(const char*& conservar) {
+    if (descriptor < 0) return false;
+    
+    size_t guardados = fin - conservar;
+    std::memmove(&buffer[0], conservar, guardados);
+    if (buffer.size() < guardados + TAMANO_LECTURA) buffer.resize(guardados + TAMANO_LECTURA);
+    
+    ssize_t leidos;
+    do {
+        leidos = read(descriptor, &buffer[guardados], buffer.size() - guardados);
+    } while (leidos < 0 && errno == EINTR);
+    
+    inicio = &buffer[0];
+    conservar = inicio;
+    cursor = inicio + guardados;
+    fin = cursor + (leidos > 0 ? leidos : 0);
+    return leidos > 0;
+}
+
+void LectorEscenarios::cerrar() {
+    descriptor = -1;
+    if (proyeccion != 0) {
+        munmap(proyeccion, tamanoProyeccion);
+        proyeccion = 0;
+        tamanoProyeccion = 0;
+    }
+    std::vector<char>().swap(buffer);
+    inicio = fin = cursor = 0;
+}
+
+bool LectorEscenarios::saltarEspacios() {
+    while (true) {
+        while (cursor < fin && esEspacio(*cursor)) {
+            if (*cursor == '\n') linea++;
+            cursor++;
+        }
+        const char* resto = cursor; // Nada que conservar
+        if (cursor < fin || !rellenar(resto)) return cursor < fin;
+    }
+}
+
+bool LectorEscenarios::esperarEntrada() {
+    if (descriptor < 0) return true; // rellenar() dirá que no hay más
+    
+    pollfd espera;
+    espera.fd = descriptor;
+    espera.events = POLLIN;
+    int listos;
+    do {
+        listos = poll(&espera, 1, ESPERA_CIERRE_MS);
+    } while (listos < 0 && errno == EINTR);
+    return listos != 0; // Un error de poll lo informará read()
+}
+
+bool LectorEscenarios::siguienteToken(const char*& desde, const char*& hasta,
+                                      bool cierraEscenario) {
+    // En modo flujo un token puede quedar partido entre dos lecturas: se
+    // conserva lo leído y se sigue tras rellenar. El que cierra un
+    // escenario no puede quedarse esperando en read() a un espacio que el
+    // cliente quizás no envíe (él espera la respuesta)
+    desde = cursor;
+    while (true) {
+        while (cursor < fin && !esEspacio(*cursor)) {
+            cursor++;
+        }
+        if (cursor < fin) break;
+        if (cierraEscenario && !esperarEntrada()) {
+            hasta = cursor;
+            return false;
+        }
+        if (!rellenar(desde)) break;
+    }
+    hasta = cursor;
+    return true;
+}
+
+bool LectorEscenarios::fallar(const std::string& mensaje) {
+    std::ostringstream texto;
+    texto << "linea " << linea << ": " << mensaje;
+    error = texto.str();
+    return false;
+}
+
+bool LectorEscenarios::leerEntero(int& valor, bool cierraEscenario) {
+    if (!saltarEspacios()) return fallar("se esperaba un entero y termino el archivo");
+    const char* desde;
+    const char* hasta;
+    if (!siguienteToken(desde, hasta, cierraEscenario)) {
+        return fallar("el escenario debe terminar en un salto de linea (tras '" +
+                      std::string(desde, hasta) + "')");
+    }
+    
+    const char* p = desde;
+    bool negativo = false;
+    if (*p == '-' || *p == '+') {
+        negativo = (*p == '-');
+        p++;
+    }
+    if (p == hasta) {
+        return fallar("entero mal formado '" + std::string(desde, hasta) + "'");
+    }
+    
+    long long acumulado = 0;
+    for (; p < hasta; p++) {
+        if (!esDigito(*p)) {
+            return fallar("entero mal formado '" + std::string(desde, hasta) + "'");
+        }
+        acumulado = acumulado * 10 + (*p - '0');
+        if (acumulado > 2147483647LL) {
+            return fallar("entero fuera de rango '" + std::string(desde, hasta) + "'");
+        }
+    }
+    valor = (int)(negativo ? -acumulado : acumulado);
+    return true;
+}
+
+bool LectorEscenarios::leerReal(double& valor, bool cierraEscenario) {
+    if (!saltarEspacios()) return fallar("se esperaba un numero y termino el archivo");
+    const char* desde;
+    const char* hasta;
+    if (!siguienteToken(desde, hasta, cierraEscenario)) {
+        return fallar("el escenario debe terminar en un salto de linea (tras '" +
+                      std::string(desde, hasta) + "')");
+    }
+    
+    if (convertirRapido(desde, hasta, valor)) return true;
+    
+    // Casos poco comunes (exponentes, muchos dígitos): strtod sobre una
+    // copia terminada en '\0' en la pila
+    char copia[64];
+    size_t largo = hasta - desde;
+    if (largo >= sizeof(copia)) {
+        return fallar("numero demasiado largo '" + std::string(desde, hasta) + "'");
+    }
+    std::memcpy(copia, desde, largo);
+    copia[largo] = '\0';
+    char* final;
+    valor = std::strtod(copia, &final);
+    if (final != copia + largo || !std::isfinite(valor)) {
+        return fallar("numero mal formado '" + std::string(desde, hasta) + "'");
+    }
+    return true;
+}
+
+bool LectorEscenarios::leerCabecera(int& k, int& m) {
+    if (!leerEntero(k)) return false;
+    if (k < 1) return fallar("la capacidad k debe ser al menos 1");
+    if (!leerEntero(m, true)) return false;
+    if (m < 0) return fallar("el numero de productos m no puede ser negativo");
+    return true;
+}
+
+bool LectorEscenarios::leerCoordenadas(int m, std::vector<double>& coordenadas) {
+    coordenadas.resize(2 * (size_t)m);
+    for (size_t i = 0; i < coordenadas.size(); i++) {
+        if (!leerReal(coordenadas[i], i + 1 == coordenadas.size())) return false;
+    }
+    return true;
+}
@@ -0,0 +1,96 @@
+#ifndef LECTORESCENARIOS_H
+#define LECTORESCENARIOS_H
+
+#include <string>
+#include <vector>
+
+// Lector del formato de texto de escenarios:
+//   n
+//   k m
+//   x1 y1
+//   ...
+// El archivo se proyecta en memoria (mmap) y los números se convierten
+// directamente desde el buffer, sin flujos ni locale y sin reservar memoria
+// por número. Los errores indican la línea donde ocurrieron.
+// También puede leer de un descriptor (entrada estándar, socket) a medida
+// que llegan los datos: el buffer se rellena con read() cuando se agota,
+// así cada escenario se procesa apenas termina de llegar. En ese modo
+// cada escenario debe terminar en un salto de línea (o en el fin de la
+// entrada): sin él no se sabe si su último número está completo.
+class LectorEscenarios {
+public:
+    LectorEscenarios();
+    ~LectorEscenarios();
+    
+    // Abre y proyecta el archivo; false si no se pudo
+    bool abrir(const std::string& archivo);
+    
+    // Lee del descriptor dado a medida que llegan los datos (no lo cierra)
+    void abrirDescriptor(int descriptor);
+    
+    // Libera la proyección
+    void cerrar();
+    
+    // Indica si queda algún número por leer; en un descriptor espera a que
+    // llegue más entrada o a que se cierre
+    bool quedanDatos() { return saltarEspacios(); }
+    
+    // Leen el siguiente número; false (y getError()) si falta o está mal
+    // formado. Con cierraEscenario, en modo flujo, el número no espera
+    // indefinidamente a que llegue el espacio que lo termina: si se queda
+    // sin terminar ESPERA_CIERRE_MS sin más entrada, se rechaza
+    bool leerEntero(int& valor, bool cierraEscenario = false);
+    bool leerReal(double& valor, bool cierraEscenario = false);
+    
+    // Lee la cabecera "k m" de un escenario validando k >= 1 y m >= 0 (m
+    // cierra el escenario cuando es 0, así que se lee con cierraEscenario)
+    bool leerCabecera(int& k, int& m);
+    
+    // Lee m pares "x y" en coordenadas (x0 y0 x1 y1 ...), con una sola
+    // reserva; el último número se lee con cierraEscenario
+    bool leerCoordenadas(int m, std::vector<double>& coordenadas);
+    
+    const std::string& getError() const { return error; }
+    int getLinea() const { return linea; }
+    
+private:
+    const char* inicio;
+    const char* fin;
+    const char* cursor;
+    int linea;
+    std::string error;
+    
+    void* proyeccion;     // Resultado de mmap (0 si se usó buffer)
+    size_t tamanoProyeccion;
+    std::vector<char> buffer; // Respaldo cuando mmap no es posible
+    int descriptor;           // Descriptor en modo flujo (-1 en otro caso)
+    
+    // Bytes que se piden por cada read() en modo flujo
+    static const size_t TAMANO_LECTURA = 1 << 16;
+    
+    // Milisegundos que el número que cierra un escenario espera a que
+    // llegue el resto antes de rechazarse
+    static const int ESPERA_CIERRE_MS = 200;
+    
+    // Modo flujo: descarta lo ya consumido salvo [conservar, fin) (un token
+    // a medias) y lee más; false si no llegó nada (fin de la entrada)
+    bool rellenar(const char*& conservar);
+    
+    // Salta espacios contando saltos de línea; false si se llegó al final
+    bool saltarEspacios();
+    
+    // Modo flujo: espera hasta ESPERA_CIERRE_MS a que llegue más entrada
+    // (o se cierre); false si no llegó nada en ese plazo
+    bool esperarEntrada();
+    
+    // Deja en [desde, hasta) el siguiente token; false si cierraEscenario
+    // y el token quedó sin terminar (ver leerReal)
+    bool siguienteToken(const char*& desde, const char*& hasta, bool cierraEscenario);
+    
+    bool fallar(const std::string& mensaje);
+    
+    LectorEscenarios(const LectorEscenarios&);
+    LectorEscenarios& operator=(const LectorEscenarios&);
+};
+
+#endif
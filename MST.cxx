@@ -0,0 +1,430 @@
+#include "MST.h"
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include "Instrumentacion.h"
+#include "PoolHilos.h"
+
+// Los núcleos SIMD de Prim denso calculan la clave euclidiana; con otras
+// métricas se usa el bucle escalar
+#if defined(METRICA_EUCLIDEA) && defined(__AVX2__)
+#define PRIM_DENSO_AVX2
+#include <immintrin.h>
+#elif defined(METRICA_EUCLIDEA) && defined(__SSE2__)
+#define PRIM_DENSO_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+// Conjuntos disjuntos con compresión de caminos y unión por rango, sobre
+// arreglos del espacio de trabajo
+struct ConjuntosDisjuntos {
+    std::vector<int>& padre;
+    std::vector<int>& rango;
+    
+    ConjuntosDisjuntos(std::vector<int>& p, std::vector<int>& r, int n) : padre(p), rango(r) {
+        padre.resize(n);
+        rango.assign(n, 0);
+        for (int i = 0; i < n; i++) {
+            padre[i] = i;
+        }
+    }
+    
+    int buscar(int x) {
+        while (padre[x] != x) {
+            padre[x] = padre[padre[x]];
+            x = padre[x];
+        }
+        return x;
+    }
+    
+    // Igual que buscar() pero sin compresión de caminos, para consultar
+    // desde varios hilos a la vez; la unión por rango deja altura O(log n)
+    int raiz(int x) const {
+        while (padre[x] != x) {
+            x = padre[x];
+        }
+        return x;
+    }
+    
+    bool unir(int a, int b) {
+        a = buscar(a);
+        b = buscar(b);
+        if (a == b) return false;
+        if (rango[a] < rango[b]) std::swap(a, b);
+        padre[b] = a;
+        if (rango[a] == rango[b]) rango[a]++;
+        return true;
+    }
+};
+
+// Búsqueda del punto más cercano que pertenece a otro componente
+struct BusquedaBoruvka {
+    const ArbolKD& arbol;
+    const std::vector<int>& compPos;  // Componente de cada posición del árbol
+    const std::vector<int>& compNodo; // Componente común de un nodo o -1
+    
+    // Estado de la consulta actual
+    int componente;
+    int origen;
+    double x, y;
+    CandidatoMST* mejor;
+    
+    unsigned long long evaluaciones; // Solo con INSTRUMENTACION
+    
+    BusquedaBoruvka(const ArbolKD& a, const std::vector<int>& cp, const std::vector<int>& cn)
+        : arbol(a), compPos(cp), compNodo(cn), componente(-1), origen(-1),
+          x(0), y(0), mejor(0), evaluaciones(0) {}
+    
+    void visitar(int id) {
+        const ArbolKD::Nodo& nodo = arbol.getNodos()[id];
+        if (compNodo[id] == componente) return;
+        // Poda estricta: con igual distancia aún puede ganar el desempate
+        if (ArbolKD::claveCaja(nodo, x, y) > mejor->clave) return;
+        
+        if (nodo.izq < 0) {
+            const std::vector<Coordenada>& xs = arbol.getXs();
+            const std::vector<Coordenada>& ys = arbol.getYs();
+            const std::vector<int>& indices = arbol.getIndices();
+            for (int pos = nodo.ini; pos < nodo.fin; pos++) {
+                if (compPos[pos] == componente) continue;
+                CandidatoMST c;
+                c.clave = Metrica::clave(xs[pos] - x, ys[pos] - y);
+                CONTAR(evaluaciones, 1);
+                c.u = std::min(origen, indices[pos]);
+                c.v = std::max(origen, indices[pos]);
+                if (c.mejoraA(*mejor)) {
+                    *mejor = c;
+                }
+            }
+            return;
+        }
+        
+        // Visitar primero el hijo más cercano para podar antes
+        const ArbolKD::Nodo& izq = arbol.getNodos()[nodo.izq];
+        const ArbolKD::Nodo& der = arbol.getNodos()[nodo.der];
+        if (ArbolKD::claveCaja(izq, x, y) <= ArbolKD::claveCaja(der, x, y)) {
+            visitar(nodo.izq);
+            visitar(nodo.der);
+        } else {
+            visitar(nodo.der);
+            visitar(nodo.izq);
+        }
+    }
+};
+
+// Actualiza dist/padre de los r nodos pendientes con el nodo recién
+// agregado (bx, by) y devuelve la posición del pendiente más cercano.
+// Se comparan claves (Metrica.h), sin raíz; el padre se guarda como double
+// para poder mezclarlo con la misma máscara que la distancia.
+int actualizarYElegir(const double* xs, const double* ys, double* dist, double* padre,
+                      int r, double bx, double by, double b) {
+    int i = 0;
+    double minDist = std::numeric_limits<double>::infinity();
+    int minPos = -1;
+    
+#if defined(PRIM_DENSO_AVX2)
+    __m256d vbx = _mm256_set1_pd(bx);
+    __m256d vby = _mm256_set1_pd(by);
+    __m256d vb = _mm256_set1_pd(b);
+    __m256d vmin = _mm256_set1_pd(minDist);
+    __m256d vminPos = _mm256_set1_pd(-1.0);
+    __m256d vpos = _mm256_set_pd(3.0, 2.0, 1.0, 0.0);
+    __m256d vpaso = _mm256_set1_pd(4.0);
+    for (; i + 4 <= r; i += 4) {
+        __m256d dx = _mm256_sub_pd(_mm256_loadu_pd(xs + i), vbx);
+        __m256d dy = _mm256_sub_pd(_mm256_loadu_pd(ys + i), vby);
+        __m256d d2 = _mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy));
+        __m256d actual = _mm256_loadu_pd(dist + i);
+        __m256d menor = _mm256_cmp_pd(d2, actual, _CMP_LT_OQ);
+        actual = _mm256_blendv_pd(actual, d2, menor);
+        _mm256_storeu_pd(dist + i, actual);
+        _mm256_storeu_pd(padre + i, _mm256_blendv_pd(_mm256_loadu_pd(padre + i), vb, menor));
+        
+        __m256d nuevoMin = _mm256_cmp_pd(actual, vmin, _CMP_LT_OQ);
+        vmin = _mm256_blendv_pd(vmin, actual, nuevoMin);
+        vminPos = _mm256_blendv_pd(vminPos, vpos, nuevoMin);
+        vpos = _mm256_add_pd(vpos, vpaso);
+    }
+    double mins[4], poss[4];
+    _mm256_storeu_pd(mins, vmin);
+    _mm256_storeu_pd(poss, vminPos);
+    for (int l = 0; l < 4; l++) {
+        if (poss[l] >= 0 && (mins[l] < minDist || (mins[l] == minDist && (int)poss[l] < minPos))) {
+            minDist = mins[l];
+            minPos = (int)poss[l];
+        }
+    }
+#elif defined(PRIM_DENSO_SSE2)
+    __m128d vbx = _mm_set1_pd(bx);
+    __m128d vby = _mm_set1_pd(by);
+    __m128d vb = _mm_set1_pd(b);
+    __m128d vmin = _mm_set1_pd(minDist);
+    __m128d vminPos = _mm_set1_pd(-1.0);
+    __m128d vpos = _mm_set_pd(1.0, 0.0);
+    __m128d vpaso = _mm_set1_pd(2.0);
+    for (; i + 2 <= r; i += 2) {
+        __m128d dx = _mm_sub_pd(_mm_loadu_pd(xs + i), vbx);
+        __m128d dy = _mm_sub_pd(_mm_loadu_pd(ys + i), vby);
+        __m128d d2 = _mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy));
+        __m128d actual = _mm_loadu_pd(dist + i);
+        __m128d menor = _mm_cmplt_pd(d2, actual);
+        actual = _mm_or_pd(_mm_and_pd(menor, d2), _mm_andnot_pd(menor, actual));
+        _mm_storeu_pd(dist + i, actual);
+        __m128d p = _mm_loadu_pd(padre + i);
+        _mm_storeu_pd(padre + i, _mm_or_pd(_mm_and_pd(menor, vb), _mm_andnot_pd(menor, p)));
+        
+        __m128d nuevoMin = _mm_cmplt_pd(actual, vmin);
+        vmin = _mm_or_pd(_mm_and_pd(nuevoMin, actual), _mm_andnot_pd(nuevoMin, vmin));
+        vminPos = _mm_or_pd(_mm_and_pd(nuevoMin, vpos), _mm_andnot_pd(nuevoMin, vminPos));
+        vpos = _mm_add_pd(vpos, vpaso);
+    }
+    double mins[2], poss[2];
+    _mm_storeu_pd(mins, vmin);
+    _mm_storeu_pd(poss, vminPos);
+    for (int l = 0; l < 2; l++) {
+        if (poss[l] >= 0 && (mins[l] < minDist || (mins[l] == minDist && (int)poss[l] < minPos))) {
+            minDist = mins[l];
+            minPos = (int)poss[l];
+        }
+    }
+#endif
+    
+    // Resto escalar (o todo el arreglo sin SIMD)
+    for (; i < r; i++) {
+        double clave = Metrica::clave(xs[i] - bx, ys[i] - by);
+        if (clave < dist[i]) {
+            dist[i] = clave;
+            padre[i] = b;
+        }
+        if (dist[i] < minDist || minPos < 0) {
+            minDist = dist[i];
+            minPos = i;
+        }
+    }
+    
+    return minPos;
+}
+
+// Bloques de posiciones por hilo en cada fase paralela de Borůvka: varios
+// por hilo para que el robo de trabajo reparta las zonas más costosas
+const int BLOQUES_POR_HILO = 16;
+
+// Ejecuta tarea(b) para cada bloque b en el pool
+void repartir(PoolHilos& pool, int numBloques, const std::function<void(int)>& tarea) {
+    pool.ejecutar(numBloques, [&tarea](int b, int) { tarea(b); });
+}
+
+// Arista más corta saliente de cada componente, buscada en paralelo. Cada
+// bloque de posiciones consecutivas del árbol kd (casi siempre de un mismo
+// componente) deja la mejor candidata de cada tramo de posiciones de un
+// mismo componente; luego se reducen por componente. Como CandidatoMST
+// tiene un orden total, el resultado no depende del reparto.
+unsigned long long buscarCandidatasParalelo(const ArbolKD& arbol, EspacioMST& espacio,
+                                            PoolHilos& pool) {
+    const std::vector<int>& indices = arbol.getIndices();
+    int n = indices.size();
+    int numBloques = std::min(n, pool.getNumHilos() * BLOQUES_POR_HILO);
+    std::vector<std::vector<std::pair<int, CandidatoMST> > >& candidatas = espacio.candidatasBloque;
+    std::vector<unsigned long long>& evaluaciones = espacio.evaluacionesBloque;
+    candidatas.resize(numBloques);
+    evaluaciones.assign(numBloques, 0);
+    
+    repartir(pool, numBloques, [&](int b) {
+        int desde = (long long)n * b / numBloques;
+        int hasta = (long long)n * (b + 1) / numBloques;
+        BusquedaBoruvka busqueda(arbol, espacio.compPos, espacio.compNodo);
+        std::vector<std::pair<int, CandidatoMST> >& salida = candidatas[b];
+        salida.clear();
+        
+        CandidatoMST mejor;
+        for (int pos = desde; pos < hasta; pos++) {
+            int c = espacio.compPos[pos];
+            if (pos > desde && c != espacio.compPos[pos - 1]) {
+                salida.push_back(std::make_pair(espacio.compPos[pos - 1], mejor));
+                mejor = CandidatoMST();
+            }
+            busqueda.componente = c;
+            busqueda.origen = indices[pos];
+            busqueda.x = arbol.getXs()[pos];
+            busqueda.y = arbol.getYs()[pos];
+            busqueda.mejor = &mejor;
+            busqueda.visitar(0);
+        }
+        if (hasta > desde) salida.push_back(std::make_pair(espacio.compPos[hasta - 1], mejor));
+        evaluaciones[b] = busqueda.evaluaciones;
+    });
+    
+    unsigned long long total = 0;
+    for (int b = 0; b < numBloques; b++) {
+        for (size_t i = 0; i < candidatas[b].size(); i++) {
+            const std::pair<int, CandidatoMST>& candidata = candidatas[b][i];
+            if (candidata.second.mejoraA(espacio.mejorComp[candidata.first])) {
+                espacio.mejorComp[candidata.first] = candidata.second;
+            }
+        }
+        total += evaluaciones[b];
+    }
+    return total;
+}
+
+}
+
+std::vector<Arista> mstPrimDenso(const Coordenadas& coordenadas, int nodoInicial) {
+    std::vector<Arista> mst;
+    EspacioMST espacio;
+    mstPrimDenso(coordenadas, nodoInicial, mst, espacio);
+    return mst;
+}
+
+void mstPrimDenso(const Coordenadas& coordenadas, int nodoInicial,
+                  std::vector<Arista>& mst, EspacioMST& espacio) {
+    int n = coordenadas.size();
+    mst.clear();
+    if (n < 2) return;
+    mst.reserve(n - 1);
+    
+    // Pendientes compactados al inicio de los arreglos: al incorporar un
+    // nodo se intercambia con el último, así cada pasada recorre solo los
+    // r nodos que faltan y no necesita máscaras de visitados. Se trabaja en
+    // double aunque las coordenadas se guarden en float.
+    std::vector<double>& xs = espacio.xs;
+    std::vector<double>& ys = espacio.ys;
+    std::vector<double>& dist = espacio.dist;
+    std::vector<double>& padre = espacio.padre;
+    std::vector<int>& ids = espacio.ids;
+    xs.clear();
+    ys.clear();
+    ids.clear();
+    for (int i = 0; i < n; i++) {
+        if (i == nodoInicial) continue;
+        xs.push_back(coordenadas.x(i));
+        ys.push_back(coordenadas.y(i));
+        ids.push_back(i);
+    }
+    dist.assign(n - 1, std::numeric_limits<double>::infinity());
+    padre.assign(n - 1, (double)nodoInicial);
+    
+    int r = n - 1;
+    int actual = nodoInicial;
+    double bx = coordenadas.x(actual);
+    double by = coordenadas.y(actual);
+    
+    while (r > 0) {
+        int pos = actualizarYElegir(&xs[0], &ys[0], &dist[0], &padre[0], r, bx, by, actual);
+        
+        actual = ids[pos];
+        bx = xs[pos];
+        by = ys[pos];
+        mst.push_back(Arista((int)padre[pos], actual, Metrica::desdeClave(dist[pos])));
+        
+        r--;
+        xs[pos] = xs[r];
+        ys[pos] = ys[r];
+        dist[pos] = dist[r];
+        padre[pos] = padre[r];
+        ids[pos] = ids[r];
+    }
+}
+
+std::vector<Arista> mstBoruvkaKD(const Coordenadas& coordenadas) {
+    ArbolKD arbol;
+    arbol.construir(coordenadas);
+    return mstBoruvkaKD(arbol);
+}
+
+std::vector<Arista> mstBoruvkaKD(const ArbolKD& arbol, unsigned long long* evaluaciones) {
+    std::vector<Arista> mst;
+    EspacioMST espacio;
+    mstBoruvkaKD(arbol, mst, espacio, evaluaciones);
+    return mst;
+}
+
+void mstBoruvkaKD(const ArbolKD& arbol, std::vector<Arista>& mst, EspacioMST& espacio,
+                  unsigned long long* evaluaciones, PoolHilos* pool) {
+    int n = arbol.getIndices().size();
+    mst.clear();
+    if (n < 2) return;
+    mst.reserve(n - 1);
+    
+    const std::vector<ArbolKD::Nodo>& nodos = arbol.getNodos();
+    const std::vector<int>& indices = arbol.getIndices();
+    int numNodos = nodos.size();
+    
+    ConjuntosDisjuntos conjuntos(espacio.padreConjunto, espacio.rangoConjunto, n);
+    std::vector<int>& compPos = espacio.compPos;
+    std::vector<int>& compNodo = espacio.compNodo;
+    std::vector<CandidatoMST>& mejorComp = espacio.mejorComp;
+    std::vector<int>& raices = espacio.raices;
+    compPos.resize(n);
+    compNodo.resize(numNodos);
+    mejorComp.resize(n);
+    BusquedaBoruvka busqueda(arbol, compPos, compNodo);
+    
+    while ((int)mst.size() < n - 1) {
+        if (pool != 0) {
+            int numBloques = std::min(n, pool->getNumHilos() * BLOQUES_POR_HILO);
+            repartir(*pool, numBloques, [&](int b) {
+                int hasta = (long long)n * (b + 1) / numBloques;
+                for (int pos = (long long)n * b / numBloques; pos < hasta; pos++) {
+                    compPos[pos] = conjuntos.raiz(indices[pos]);
+                }
+            });
+        } else {
+            for (int pos = 0; pos < n; pos++) {
+                compPos[pos] = conjuntos.buscar(indices[pos]);
+            }
+        }
+        
+        // Los hijos siempre tienen id mayor que su padre: recorrer hacia atrás
+        for (int id = numNodos - 1; id >= 0; id--) {
+            const ArbolKD::Nodo& nodo = nodos[id];
+            if (nodo.izq < 0) {
+                int c = compPos[nodo.ini];
+                for (int pos = nodo.ini + 1; pos < nodo.fin && c >= 0; pos++) {
+                    if (compPos[pos] != c) c = -1;
+                }
+                compNodo[id] = c;
+            } else {
+                int c = compNodo[nodo.izq];
+                compNodo[id] = (c == compNodo[nodo.der]) ? c : -1;
+            }
+        }
+        
+        for (int pos = 0; pos < n; pos++) {
+            int c = compPos[pos];
+            mejorComp[c] = CandidatoMST();
+        }
+        
+        // Arista más corta saliente de cada componente
+        if (pool != 0) {
+            busqueda.evaluaciones += buscarCandidatasParalelo(arbol, espacio, *pool);
+        } else {
+            for (int pos = 0; pos < n; pos++) {
+                busqueda.componente = compPos[pos];
+                busqueda.origen = indices[pos];
+                busqueda.x = arbol.getXs()[pos];
+                busqueda.y = arbol.getYs()[pos];
+                busqueda.mejor = &mejorComp[compPos[pos]];
+                busqueda.visitar(0);
+            }
+        }
+        
+        // Las raíces se fijan antes de unir: las uniones de esta ronda
+        // cambian padre[] pero cada componente conserva su candidata
+        raices.clear();
+        for (int i = 0; i < n; i++) {
+            if (conjuntos.padre[i] == i) raices.push_back(i);
+        }
+        for (size_t r = 0; r < raices.size(); r++) {
+            const CandidatoMST& c = mejorComp[raices[r]];
+            if (c.u < 0) continue;
+            if (conjuntos.unir(c.u, c.v)) {
+                mst.push_back(Arista(c.u, c.v, Metrica::desdeClave(c.clave)));
+            }
+        }
+    }
+    
+    if (evaluaciones != 0) *evaluaciones += busqueda.evaluaciones;
+}
@@ -0,0 +1,93 @@
+#ifndef MST_H
+#define MST_H
+
+#include <vector>
+#include <limits>
+#include <utility>
+#include "Coordenadas.h"
+#include "Arista.h"
+#include "ArbolKD.h"
+
+// Motor usado para construir el árbol de expansión mínima
+enum MotorMST {
+    MST_AUTOMATICO, // Elige el motor según el número de productos
+    MST_PRIM_HEAP,  // Prim perezoso con cola de prioridad, O(n² log n)
+    MST_PRIM_DENSO, // Prim con arreglos minDist/padre y kernel SIMD, O(n²)
+    MST_BORUVKA_KD  // Borůvka geométrico sobre árbol kd, O(n log n) típico
+};
+
+// Límites de productos usados por el modo automático: Prim con heap hasta
+// el primero, Prim denso hasta el segundo y Borůvka por encima
+const int UMBRAL_MST_PRIM_HEAP = 256;
+const int UMBRAL_MST_PRIM_DENSO = 5000;
+
+// Arista candidata de Borůvka con la clave de su distancia (Metrica.h), u < v
+struct CandidatoMST {
+    double clave;
+    int u, v;
+    
+    CandidatoMST() : clave(std::numeric_limits<double>::infinity()), u(-1), v(-1) {}
+    
+    // Orden total (peso, u, v): evita ciclos cuando hay distancias iguales
+    bool mejoraA(const CandidatoMST& otro) const {
+        if (clave != otro.clave) return clave < otro.clave;
+        if (u != otro.u) return u < otro.u;
+        return v < otro.v;
+    }
+};
+
+// Arreglos de trabajo de los motores. Reutilizar el mismo espacio entre
+// llamadas evita volver a pedir memoria una vez alcanzado el mayor n.
+struct EspacioMST {
+    // Prim denso: pendientes compactados
+    std::vector<double> xs, ys, dist, padre;
+    std::vector<int> ids;
+    
+    // Borůvka: conjuntos disjuntos, componente por posición y por nodo del
+    // árbol kd, y mejor candidata de cada componente
+    std::vector<int> padreConjunto, rangoConjunto;
+    std::vector<int> compPos, compNodo, raices;
+    std::vector<CandidatoMST> mejorComp;
+    
+    // Borůvka paralelo: candidatas (componente, arista) y distancias
+    // evaluadas por bloque de posiciones
+    std::vector<std::vector<std::pair<int, CandidatoMST> > > candidatasBloque;
+    std::vector<unsigned long long> evaluacionesBloque;
+};
+
+class PoolHilos;
+
+// Prim denso desde nodoInicial: mantiene la distancia mínima de cada nodo
+// pendiente al árbol en arreglos contiguos (estructura de arreglos) y en
+// cada paso actualiza y elige el siguiente nodo en una sola pasada
+// vectorizada (AVX2, SSE2 o escalar según la compilación y la métrica).
+// Memoria O(n).
+// Devuelve las aristas en orden de incorporación, como algoritmoPrim.
+std::vector<Arista> mstPrimDenso(const Coordenadas& coordenadas, int nodoInicial);
+
+// Igual, dejando las aristas en mst y usando los arreglos de espacio
+void mstPrimDenso(const Coordenadas& coordenadas, int nodoInicial,
+                  std::vector<Arista>& mst, EspacioMST& espacio);
+
+// MST por Borůvka en la métrica de Metrica.h: en cada ronda cada
+// componente busca, con ayuda de un árbol kd, su arista más corta hacia
+// otro componente. Los
+// empates se rompen por (peso, menor índice, mayor índice), por lo que el
+// peso total coincide con el de Prim.
+std::vector<Arista> mstBoruvkaKD(const Coordenadas& coordenadas);
+
+// Igual, reutilizando un árbol kd ya construido sobre los mismos productos.
+// Con INSTRUMENTACION suma a *evaluaciones (si no es nulo) las distancias
+// calculadas durante las búsquedas.
+std::vector<Arista> mstBoruvkaKD(const ArbolKD& arbol, unsigned long long* evaluaciones = 0);
+
+// Igual, dejando las aristas en mst y usando los arreglos de espacio. Con
+// pool no nulo cada ronda reparte entre sus hilos el cálculo de componentes
+// y la búsqueda de la arista más corta de cada uno; las uniones (O(número
+// de componentes) por ronda) siguen en este hilo y en el mismo orden, así
+// que las aristas salen idénticas, y en el mismo orden, con cualquier
+// número de hilos.
+void mstBoruvkaKD(const ArbolKD& arbol, std::vector<Arista>& mst, EspacioMST& espacio,
+                  unsigned long long* evaluaciones = 0, PoolHilos* pool = 0);
+
+#endif
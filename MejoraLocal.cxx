@@ -0,0 +1,269 @@
+#include "MejoraLocal.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <deque>
+
+namespace {
+
+typedef std::chrono::steady_clock Reloj;
+
+// Mejora mínima para aceptar un movimiento (evita ciclos por redondeo)
+const double EPSILON = 1e-9;
+
+// Largo máximo de los segmentos que mueve Or-opt / reubicar
+const int LARGO_MAX_SEGMENTO = 3;
+
+class BusquedaLocal {
+public:
+    BusquedaLocal(const Coordenadas& coordenadas_, const Producto& base_,
+                  std::vector<std::vector<int> >& viajes_, int capacidad_,
+                  const std::vector<int>& vecinos_, int numVecinos_)
+        : coordenadas(coordenadas_), base(base_), viajes(viajes_), capacidad(capacidad_),
+          vecinos(vecinos_), numVecinos(numVecinos_),
+          viajeDe(coordenadas_.size(), -1), posEn(coordenadas_.size(), -1),
+          enCola(coordenadas_.size(), 0) {
+        for (size_t t = 0; t < viajes.size(); t++) {
+            reindexar(t);
+        }
+    }
+    
+    // Aplica movimientos hasta el óptimo local o hasta el límite de tiempo
+    int ejecutar(bool conLimite, Reloj::time_point limite) {
+        for (size_t t = 0; t < viajes.size(); t++) {
+            for (size_t i = 0; i < viajes[t].size(); i++) {
+                activar(viajes[t][i]);
+            }
+        }
+        
+        int movimientos = 0;
+        int revisados = 0;
+        while (!cola.empty()) {
+            // Consultar el reloj cada 64 productos revisados
+            if (conLimite && (++revisados & 63) == 0 && Reloj::now() >= limite) break;
+            
+            int u = cola.front();
+            cola.pop_front();
+            enCola[u] = 0;
+            
+            if (probarDosOpt(u) || probarMoverSegmento(u) || probarIntercambio(u)) {
+                movimientos++;
+                activar(u);
+            }
+        }
+        return movimientos;
+    }
+    
+private:
+    const Coordenadas& coordenadas;
+    const Producto& base;
+    std::vector<std::vector<int> >& viajes;
+    int capacidad;
+    const std::vector<int>& vecinos;
+    int numVecinos;
+    
+    std::vector<int> viajeDe; // Viaje de cada producto
+    std::vector<int> posEn;   // Posición dentro de su viaje
+    std::vector<char> enCola; // Bit "no mirar" invertido: 1 = pendiente de revisar
+    std::deque<int> cola;
+    
+    // -1 representa a la base
+    double d(int a, int b) const {
+        double dx = (a < 0 ? base.x : coordenadas.x(a)) - (b < 0 ? base.x : coordenadas.x(b));
+        double dy = (a < 0 ? base.y : coordenadas.y(a)) - (b < 0 ? base.y : coordenadas.y(b));
+        return Metrica::distancia(dx, dy);
+    }
+    
+    int anterior(int u) const {
+        int p = posEn[u];
+        return p > 0 ? viajes[viajeDe[u]][p - 1] : -1;
+    }
+    
+    int siguiente(int u) const {
+        const std::vector<int>& viaje = viajes[viajeDe[u]];
+        int p = posEn[u];
+        return p + 1 < (int)viaje.size() ? viaje[p + 1] : -1;
+    }
+    
+    int vecino(int u, int j) const { return vecinos[(size_t)u * numVecinos + j]; }
+    
+    void reindexar(int t) {
+        const std::vector<int>& viaje = viajes[t];
+        for (size_t p = 0; p < viaje.size(); p++) {
+            viajeDe[viaje[p]] = t;
+            posEn[viaje[p]] = p;
+        }
+    }
+    
+    void activar(int u) {
+        if (u >= 0 && !enCola[u]) {
+            enCola[u] = 1;
+            cola.push_back(u);
+        }
+    }
+    
+    // 2-opt dentro del viaje de u contra cada vecino c del mismo viaje
+    bool probarDosOpt(int u) {
+        int t = viajeDe[u];
+        std::vector<int>& viaje = viajes[t];
+        
+        for (int j = 0; j < numVecinos; j++) {
+            int c = vecino(u, j);
+            if (c < 0 || viajeDe[c] != t) continue;
+            int a = (posEn[u] < posEn[c]) ? u : c; // El que aparece antes
+            int b = (a == u) ? c : u;
+            
+            // (a, na) y (b, nb) -> (a, b) y (na, nb): invertir [na .. b]
+            int na = siguiente(a);
+            int nb = siguiente(b);
+            if (na != b && d(a, b) + d(na, nb) - d(a, na) - d(b, nb) < -EPSILON) {
+                std::reverse(viaje.begin() + posEn[a] + 1, viaje.begin() + posEn[b] + 1);
+                reindexar(t);
+                activar(a); activar(b); activar(na); activar(nb);
+                return true;
+            }
+            
+            // (pa, a) y (pb, b) -> (pa, pb) y (a, b): invertir [a .. pb]
+            int pa = anterior(a);
+            int pb = anterior(b);
+            if (pb != a && d(pa, pb) + d(a, b) - d(pa, a) - d(pb, b) < -EPSILON) {
+                std::reverse(viaje.begin() + posEn[a], viaje.begin() + posEn[b]);
+                reindexar(t);
+                activar(a); activar(b); activar(pa); activar(pb);
+                return true;
+            }
+        }
+        return false;
+    }
+    
+    // Or-opt (mismo viaje) y reubicación (otro viaje con capacidad) del
+    // segmento que empieza en u, junto a un vecino de alguno de sus extremos
+    bool probarMoverSegmento(int u) {
+        int A = viajeDe[u];
+        int i = posEn[u];
+        
+        for (int largo = 1; largo <= LARGO_MAX_SEGMENTO; largo++) {
+            if (i + largo > (int)viajes[A].size()) break;
+            int s0 = u;
+            int sL = viajes[A][i + largo - 1];
+            int p = anterior(s0);
+            int q = siguiente(sL);
+            double ganancia = d(p, s0) + d(sL, q) - d(p, q);
+            if (ganancia <= EPSILON) continue;
+            
+            for (int extremo = 0; extremo < 2; extremo++) {
+                int desde = (extremo == 0) ? s0 : sL;
+                if (extremo == 1 && sL == s0) break;
+                
+                for (int j = 0; j < numVecinos; j++) {
+                    int c = vecino(desde, j);
+                    if (c < 0) continue;
+                    int B = viajeDe[c];
+                    if (B == A && posEn[c] >= i && posEn[c] < i + largo) continue;
+                    if (B != A && (int)viajes[B].size() + largo > capacidad) continue;
+                    
+                    // Vecinos de c una vez retirado el segmento
+                    int nc = siguiente(c);
+                    if (nc == s0) nc = q;
+                    int pc = anterior(c);
+                    if (pc == sL) pc = p;
+                    
+                    // Cuatro formas de insertar: antes/después de c, directo/invertido
+                    double costos[4] = {
+                        d(c, s0) + d(sL, nc) - d(c, nc),
+                        d(c, sL) + d(s0, nc) - d(c, nc),
+                        d(pc, s0) + d(sL, c) - d(pc, c),
+                        d(pc, sL) + d(s0, c) - d(pc, c)
+                    };
+                    int mejor = std::min_element(costos, costos + 4) - costos;
+                    if (costos[mejor] - ganancia >= -EPSILON) continue;
+                    
+                    std::vector<int> segmento(viajes[A].begin() + i, viajes[A].begin() + i + largo);
+                    if (mejor == 1 || mejor == 3) {
+                        std::reverse(segmento.begin(), segmento.end());
+                    }
+                    viajes[A].erase(viajes[A].begin() + i, viajes[A].begin() + i + largo);
+                    reindexar(A);
+                    int destino = posEn[c] + ((mejor < 2) ? 1 : 0);
+                    viajes[B].insert(viajes[B].begin() + destino, segmento.begin(), segmento.end());
+                    reindexar(B);
+                    
+                    activar(p); activar(q); activar(c); activar(nc); activar(pc);
+                    for (size_t k = 0; k < segmento.size(); k++) {
+                        activar(segmento[k]);
+                    }
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+    
+    // Intercambia u con un vecino c de otro viaje (las cargas no cambian)
+    bool probarIntercambio(int u) {
+        int A = viajeDe[u];
+        for (int j = 0; j < numVecinos; j++) {
+            int c = vecino(u, j);
+            if (c < 0 || viajeDe[c] == A) continue;
+            
+            int pu = anterior(u), nu = siguiente(u);
+            int pc = anterior(c), nc = siguiente(c);
+            double delta = d(pu, c) + d(c, nu) - d(pu, u) - d(u, nu)
+                         + d(pc, u) + d(u, nc) - d(pc, c) - d(c, nc);
+            if (delta >= -EPSILON) continue;
+            
+            int B = viajeDe[c];
+            std::swap(viajes[A][posEn[u]], viajes[B][posEn[c]]);
+            std::swap(viajeDe[u], viajeDe[c]);
+            std::swap(posEn[u], posEn[c]);
+            activar(c); activar(pu); activar(nu); activar(pc); activar(nc);
+            return true;
+        }
+        return false;
+    }
+};
+
+}
+
+double distanciaViajes(const Coordenadas& coordenadas, const Producto& base,
+                       const std::vector<std::vector<int> >& viajes) {
+    double total = 0.0;
+    for (size_t t = 0; t < viajes.size(); t++) {
+        const std::vector<int>& viaje = viajes[t];
+        if (viaje.empty()) continue;
+        total += coordenadas.distanciaA(viaje[0], base.x, base.y);
+        for (size_t i = 1; i < viaje.size(); i++) {
+            total += coordenadas.distancia(viaje[i - 1], viaje[i]);
+        }
+        total += coordenadas.distanciaA(viaje.back(), base.x, base.y);
+    }
+    return total;
+}
+
+ResultadoMejora mejorarViajes(const Coordenadas& coordenadas, const Producto& base,
+                              std::vector<std::vector<int> >& viajes, int capacidad,
+                              const std::vector<int>& vecinos, int numVecinos,
+                              double presupuestoMs) {
+    Reloj::time_point inicio = Reloj::now();
+    Reloj::time_point limite = inicio + std::chrono::microseconds((long long)(presupuestoMs * 1000.0));
+    
+    ResultadoMejora resultado;
+    resultado.distanciaAntes = distanciaViajes(coordenadas, base, viajes);
+    
+    BusquedaLocal busqueda(coordenadas, base, viajes, capacidad, vecinos, numVecinos);
+    resultado.movimientos = busqueda.ejecutar(presupuestoMs > 0, limite);
+    
+    // Descartar viajes que quedaron vacíos por las reubicaciones
+    size_t escritos = 0;
+    for (size_t t = 0; t < viajes.size(); t++) {
+        if (!viajes[t].empty()) {
+            if (escritos != t) viajes[escritos].swap(viajes[t]);
+            escritos++;
+        }
+    }
+    viajes.resize(escritos);
+    
+    resultado.distanciaDespues = distanciaViajes(coordenadas, base, viajes);
+    resultado.tiempoMs = std::chrono::duration<double, std::milli>(Reloj::now() - inicio).count();
+    return resultado;
+}
@@ -0,0 +1,42 @@
+#ifndef MEJORALOCAL_H
+#define MEJORALOCAL_H
+
+#include <vector>
+#include "Coordenadas.h"
+
+// Resultado de una pasada de mejora local
+struct ResultadoMejora {
+    double distanciaAntes;
+    double distanciaDespues;
+    double tiempoMs;
+    int movimientos; // Movimientos aplicados
+    
+    ResultadoMejora() : distanciaAntes(0), distanciaDespues(0), tiempoMs(0), movimientos(0) {}
+    
+    // Metros ahorrados por milisegundo invertido
+    double gananciaPorMs() const {
+        return tiempoMs > 0 ? (distanciaAntes - distanciaDespues) / tiempoMs : 0.0;
+    }
+};
+
+// Búsqueda local sobre los viajes (cada viaje sale y vuelve a la base):
+//   - 2-opt dentro de cada viaje
+//   - Or-opt: mover segmentos de 1 a 3 productos dentro del viaje
+//   - reubicar segmentos y intercambiar productos entre viajes sin
+//     superar la capacidad
+// Los movimientos se generan solo con los numVecinos vecinos más cercanos
+// de cada producto (vecinos[u * numVecinos + j], -1 si faltan) y con bits
+// "no mirar": solo se revisan productos cuyo entorno cambió. Se detiene al
+// no encontrar mejoras o al agotar presupuestoMs de tiempo real
+// (sin límite si presupuestoMs <= 0).
+// Los viajes que quedan vacíos se eliminan.
+ResultadoMejora mejorarViajes(const Coordenadas& coordenadas, const Producto& base,
+                              std::vector<std::vector<int> >& viajes, int capacidad,
+                              const std::vector<int>& vecinos, int numVecinos,
+                              double presupuestoMs);
+
+// Distancia total de un conjunto de viajes
+double distanciaViajes(const Coordenadas& coordenadas, const Producto& base,
+                       const std::vector<std::vector<int> >& viajes);
+
+#endif
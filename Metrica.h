@@ -0,0 +1,55 @@
+#ifndef METRICA_H
+#define METRICA_H
+
+#include <cmath>
+
+// Métricas de distancia entre dos puntos separados por (dx, dy). Cada una
+// ofrece, como funciones estáticas que el compilador inlinea:
+//   clave(dx, dy)      valor que crece con la distancia, para comparar
+//   desdeClave(c)      distancia que corresponde a una clave
+//   distancia(dx, dy)  igual a desdeClave(clave(dx, dy))
+// La clave euclidiana es la distancia al cuadrado: elegir el más cercano,
+// podar cajas del árbol kd o comparar aristas no necesita sqrt, que se paga
+// solo al informar longitudes. En las tres métricas la clave de los huecos
+// por eje entre un punto y una caja acota por debajo la clave hasta
+// cualquier punto de la caja.
+struct MetricaEuclidea {
+    static const char* nombre() { return "euclidianas"; }
+    static double clave(double dx, double dy) { return dx * dx + dy * dy; }
+    static double desdeClave(double c) { return std::sqrt(c); }
+    static double distancia(double dx, double dy) { return std::sqrt(dx * dx + dy * dy); }
+};
+
+// Robots que solo avanzan a lo largo de los pasillos, un eje por vez
+struct MetricaManhattan {
+    static const char* nombre() { return "manhattan"; }
+    static double clave(double dx, double dy) { return std::fabs(dx) + std::fabs(dy); }
+    static double desdeClave(double c) { return c; }
+    static double distancia(double dx, double dy) { return clave(dx, dy); }
+};
+
+// Robots que mueven ambos ejes a la vez: manda el desplazamiento más largo
+struct MetricaChebyshev {
+    static const char* nombre() { return "chebyshev"; }
+    static double clave(double dx, double dy) {
+        double ax = std::fabs(dx);
+        double ay = std::fabs(dy);
+        return ax > ay ? ax : ay;
+    }
+    static double desdeClave(double c) { return c; }
+    static double distancia(double dx, double dy) { return clave(dx, dy); }
+};
+
+// Métrica de esta compilación. Se fija al compilar, como Coordenada, para
+// que los bucles internos no paguen llamadas virtuales ni bifurcaciones:
+// make METRICA=manhattan o make METRICA=chebyshev; euclidiana por defecto.
+#if defined(METRICA_MANHATTAN)
+typedef MetricaManhattan Metrica;
+#elif defined(METRICA_CHEBYSHEV)
+typedef MetricaChebyshev Metrica;
+#else
+#define METRICA_EUCLIDEA
+typedef MetricaEuclidea Metrica;
+#endif
+
+#endif
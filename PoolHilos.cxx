@@ -0,0 +1,116 @@
+#include "PoolHilos.h"
+
+PoolHilos::PoolHilos(int numHilos)
+    : tareaActual(0), pendientes(0), activos(0), ronda(0), detener(false) {
+    if (numHilos <= 0) {
+        numHilos = std::thread::hardware_concurrency();
+        if (numHilos <= 0) numHilos = 1;
+    }
+    for (int i = 0; i < numHilos; i++) {
+        colas.push_back(new Cola());
+    }
+    for (int i = 0; i < numHilos; i++) {
+        hilos.push_back(std::thread(&PoolHilos::trabajar, this, i));
+    }
+}
+
+PoolHilos::~PoolHilos() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        detener = true;
+    }
+    hayTrabajo.notify_all();
+    for (size_t i = 0; i < hilos.size(); i++) {
+        hilos[i].join();
+    }
+    for (size_t i = 0; i < colas.size(); i++) {
+        delete colas[i];
+    }
+}
+
+void PoolHilos::ejecutar(int numTareas, const std::function<void(int, int)>& tarea) {
+    if (numTareas <= 0) return;
+    int numHilos = colas.size();
+    
+    // Las colas se llenan con el mutex general tomado: ningún hilo puede
+    // estar aún en la ronda anterior, porque cada ronda espera a que todos
+    // los hilos la hayan dejado (activos == 0), no solo los que llegaron a
+    // despertarse
+    std::unique_lock<std::mutex> lock(mutex);
+    
+    // Repartir en bloques contiguos: cada hilo empieza por los suyos
+    for (int h = 0; h < numHilos; h++) {
+        int desde = (long long)numTareas * h / numHilos;
+        int hasta = (long long)numTareas * (h + 1) / numHilos;
+        std::lock_guard<std::mutex> lockCola(colas[h]->mutex);
+        for (int i = desde; i < hasta; i++) {
+            colas[h]->tareas.push_back(i);
+        }
+    }
+    
+    // Todos los hilos quedan anotados en la ronda antes de avisarles: uno
+    // que despierte tarde la encuentra en curso (o sin tareas) y nunca ve
+    // la tarea de otra ronda
+    tareaActual = &tarea;
+    pendientes = numTareas;
+    activos = numHilos;
+    ronda++;
+    hayTrabajo.notify_all();
+    terminado.wait(lock, [this] { return pendientes == 0 && activos == 0; });
+    tareaActual = 0;
+}
+
+bool PoolHilos::tomarTarea(int hilo, int& tarea) {
+    int numHilos = colas.size();
+    
+    // Primero la cola propia, por delante
+    {
+        std::lock_guard<std::mutex> lock(colas[hilo]->mutex);
+        if (!colas[hilo]->tareas.empty()) {
+            tarea = colas[hilo]->tareas.front();
+            colas[hilo]->tareas.pop_front();
+            return true;
+        }
+    }
+    
+    // Luego robar del final de las demás
+    for (int i = 1; i < numHilos; i++) {
+        Cola* victima = colas[(hilo + i) % numHilos];
+        std::lock_guard<std::mutex> lock(victima->mutex);
+        if (!victima->tareas.empty()) {
+            tarea = victima->tareas.back();
+            victima->tareas.pop_back();
+            return true;
+        }
+    }
+    return false;
+}
+
+void PoolHilos::trabajar(int hilo) {
+    int rondaVista = 0;
+    while (true) {
+        const std::function<void(int, int)>* tarea;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            hayTrabajo.wait(lock, [this, rondaVista] { return detener || ronda != rondaVista; });
+            if (detener) return;
+            // ejecutar() ya lo contó en activos y no avanza de ronda hasta
+            // que lo descuente abajo, así que ronda es rondaVista + 1
+            rondaVista = ronda;
+            tarea = tareaActual;
+        }
+        
+        int indice;
+        while (tomarTarea(hilo, indice)) {
+            (*tarea)(indice, hilo);
+            
+            std::lock_guard<std::mutex> lock(mutex);
+            pendientes--;
+        }
+        
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--activos == 0 && pendientes == 0) {
+            terminado.notify_all();
+        }
+    }
+}
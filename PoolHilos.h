@@ -0,0 +1,52 @@
+#ifndef POOLHILOS_H
+#define POOLHILOS_H
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+// Pool de hilos persistente con robo de trabajo. Cada hilo tiene su propia
+// cola de tareas; al vaciarla roba del final de la cola de otro hilo, así
+// una tarea muy larga no deja esperando a las que venían detrás de ella.
+class PoolHilos {
+public:
+    // numHilos <= 0 usa std::thread::hardware_concurrency()
+    explicit PoolHilos(int numHilos);
+    ~PoolHilos();
+    
+    int getNumHilos() const { return colas.size(); }
+    
+    // Ejecuta tarea(i, hilo) para cada i en [0, numTareas) y espera a que
+    // terminen todas. hilo identifica al trabajador (0 .. getNumHilos()-1),
+    // de modo que cada uno puede reutilizar sus propias estructuras.
+    void ejecutar(int numTareas, const std::function<void(int, int)>& tarea);
+    
+private:
+    struct Cola {
+        std::mutex mutex;
+        std::deque<int> tareas;
+    };
+    
+    std::vector<Cola*> colas;
+    std::vector<std::thread> hilos;
+    
+    std::mutex mutex;
+    std::condition_variable hayTrabajo;
+    std::condition_variable terminado;
+    const std::function<void(int, int)>* tareaActual;
+    int pendientes;   // Tareas de la ronda aún sin terminar
+    int activos;      // Hilos que aún no dejaron la ronda actual
+    int ronda;        // Se incrementa en cada llamada a ejecutar()
+    bool detener;
+    
+    void trabajar(int hilo);
+    bool tomarTarea(int hilo, int& tarea);
+    
+    PoolHilos(const PoolHilos&);
+    PoolHilos& operator=(const PoolHilos&);
+};
+
+#endif
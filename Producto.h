@@ -0,0 +1,22 @@
+#ifndef PRODUCTO_H
+#define PRODUCTO_H
+
+#include "Metrica.h"
+
+// Vista de un producto (coordenadas e índice) para la interfaz pública;
+// Grafo guarda las coordenadas en estructura de arreglos (Coordenadas.h)
+struct Producto {
+    double x;
+    double y;
+    int id;
+    
+    Producto(double x_ = 0, double y_ = 0, int id_ = -1) 
+        : x(x_), y(y_), id(id_) {}
+    
+    // Calcula la distancia a otro producto según la métrica (Metrica.h)
+    double distanciaA(const Producto& otro) const {
+        return Metrica::distancia(x - otro.x, y - otro.y);
+    }
+};
+
+#endif
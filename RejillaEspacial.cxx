@@ -0,0 +1,198 @@
+#include "RejillaEspacial.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+// Octante de un desplazamiento (dx, dy): 0 y 7 dominados por +x, 1 y 2 por
+// +y, 3 y 4 por -x, 5 y 6 por -y
+int octante(double dx, double dy) {
+    if (dy >= 0) {
+        if (dx > 0) return dx >= dy ? 0 : 1;
+        return dy >= -dx ? 2 : 3;
+    }
+    if (dx < 0) return -dx >= -dy ? 4 : 5;
+    return -dy >= dx ? 6 : 7;
+}
+
+}
+
+RejillaEspacial::RejillaEspacial()
+    : tamCelda(1.0), numPuntos(0), puntosAlConstruir(0),
+      minCx(0), maxCx(-1), minCy(0), maxCy(-1) {}
+
+int RejillaEspacial::celda(double v) const {
+    return (int)std::floor(v / tamCelda);
+}
+
+void RejillaEspacial::limpiar() {
+    celdas.clear();
+    numPuntos = 0;
+    puntosAlConstruir = 0;
+    minCx = minCy = 0;
+    maxCx = maxCy = -1;
+}
+
+void RejillaEspacial::construir(const Coordenadas& coordenadas) {
+    limpiar();
+    int n = coordenadas.size();
+    tamCelda = 1.0;
+    if (n > 0) {
+        double minX = coordenadas.x(0), maxX = minX;
+        double minY = coordenadas.y(0), maxY = minY;
+        for (int i = 1; i < n; i++) {
+            minX = std::min(minX, coordenadas.x(i));
+            maxX = std::max(maxX, coordenadas.x(i));
+            minY = std::min(minY, coordenadas.y(i));
+            maxY = std::max(maxY, coordenadas.y(i));
+        }
+
+        // Celdas de área (área total · PUNTOS_POR_CELDA / n); si los
+        // productos están alineados se reparte el lado más largo
+        double ancho = maxX - minX;
+        double alto = maxY - minY;
+        double tam = std::sqrt(ancho * alto * PUNTOS_POR_CELDA / n);
+        if (!(tam > 0)) tam = std::max(ancho, alto) * PUNTOS_POR_CELDA / n;
+        if (tam > 0) tamCelda = tam;
+    }
+
+    celdas.reserve(n / PUNTOS_POR_CELDA + 1);
+    for (int i = 0; i < n; i++) {
+        insertar(i, coordenadas.x(i), coordenadas.y(i));
+    }
+    puntosAlConstruir = n;
+}
+
+void RejillaEspacial::insertar(int indice, double x, double y) {
+    int cx = celda(x);
+    int cy = celda(y);
+    celdas[clave(cx, cy)].push_back(indice);
+    if (maxCx < minCx) {
+        minCx = maxCx = cx;
+        minCy = maxCy = cy;
+    } else {
+        minCx = std::min(minCx, cx);
+        maxCx = std::max(maxCx, cx);
+        minCy = std::min(minCy, cy);
+        maxCy = std::max(maxCy, cy);
+    }
+    numPuntos++;
+}
+
+void RejillaEspacial::quitar(int indice, double x, double y) {
+    std::unordered_map<ClaveCelda, std::vector<int> >::iterator it =
+        celdas.find(clave(celda(x), celda(y)));
+    if (it == celdas.end()) return;
+
+    std::vector<int>& lista = it->second;
+    std::vector<int>::iterator pos = std::find(lista.begin(), lista.end(), indice);
+    if (pos == lista.end()) return;
+    *pos = lista.back();
+    lista.pop_back();
+    if (lista.empty()) celdas.erase(it);
+    numPuntos--;
+}
+
+void RejillaEspacial::renombrar(int viejo, int nuevo, double x, double y) {
+    std::unordered_map<ClaveCelda, std::vector<int> >::iterator it =
+        celdas.find(clave(celda(x), celda(y)));
+    if (it == celdas.end()) return;
+    std::replace(it->second.begin(), it->second.end(), viejo, nuevo);
+}
+
+void RejillaEspacial::revisarCelda(const Coordenadas& coordenadas, int cx, int cy,
+                                   double x, double y, int excluir,
+                                   double mejor[OCTANTES], int resultado[OCTANTES]) const {
+    std::unordered_map<ClaveCelda, std::vector<int> >::const_iterator it = celdas.find(clave(cx, cy));
+    if (it != celdas.end()) revisarPuntos(coordenadas, it->second, x, y, excluir, mejor, resultado);
+}
+
+void RejillaEspacial::revisarPuntos(const Coordenadas& coordenadas, const std::vector<int>& lista,
+                                    double x, double y, int excluir,
+                                    double mejor[OCTANTES], int resultado[OCTANTES]) const {
+    for (size_t i = 0; i < lista.size(); i++) {
+        int indice = lista[i];
+        if (indice == excluir) continue;
+        double dx = coordenadas.x(indice) - x;
+        double dy = coordenadas.y(indice) - y;
+        int o = octante(dx, dy);
+        double c = Metrica::clave(dx, dy);
+        if (c < mejor[o] || (c == mejor[o] && indice < resultado[o])) {
+            mejor[o] = c;
+            resultado[o] = indice;
+        }
+    }
+}
+
+bool RejillaEspacial::desbalanceada() const {
+    return numPuntos > 2 * puntosAlConstruir + 8 || (puntosAlConstruir > 64 && 4 * numPuntos < puntosAlConstruir);
+}
+
+void RejillaEspacial::masCercanosPorOctante(const Coordenadas& coordenadas, double x, double y,
+                                            int excluir, int resultado[OCTANTES]) const {
+    double mejor[OCTANTES];
+    for (int o = 0; o < OCTANTES; o++) {
+        resultado[o] = -1;
+        mejor[o] = std::numeric_limits<double>::infinity();
+    }
+    if (numPuntos == 0) return;
+
+    int cx = celda(x);
+    int cy = celda(y);
+
+    // Los anillos que no llegan al rango ocupado están vacíos
+    int primero = std::max(std::max(minCx - cx, cx - maxCx), std::max(minCy - cy, cy - maxCy));
+
+    // Celdas consultadas: si superan a las ocupadas (rejilla muy fina para
+    // los productos actuales) se revisan directamente todas las ocupadas
+    long long consultadas = 0;
+
+    for (int r = std::max(primero, 0); ; r++) {
+        // Celdas del anillo r (distancia de Chebyshev r en celdas) dentro
+        // del rango ocupado: filas superior e inferior completas y columnas
+        // laterales sin las esquinas
+        int iniX = std::max(cx - r, minCx), finX = std::min(cx + r, maxCx);
+        int iniY = std::max(cy - r + 1, minCy), finY = std::min(cy + r - 1, maxCy);
+        consultadas += 2LL * (std::max(finX - iniX + 1, 0) + std::max(finY - iniY + 1, 0));
+        if (consultadas > (long long)celdas.size()) {
+            for (std::unordered_map<ClaveCelda, std::vector<int> >::const_iterator it = celdas.begin();
+                 it != celdas.end(); ++it) {
+                revisarPuntos(coordenadas, it->second, x, y, excluir, mejor, resultado);
+            }
+            return;
+        }
+        for (int lado = 0; lado < (r == 0 ? 1 : 2); lado++) {
+            int fila = (lado == 0) ? cy - r : cy + r;
+            if (fila < minCy || fila > maxCy) continue;
+            for (int i = iniX; i <= finX; i++) {
+                revisarCelda(coordenadas, i, fila, x, y, excluir, mejor, resultado);
+            }
+        }
+        for (int lado = 0; lado < (r == 0 ? 0 : 2); lado++) {
+            int columna = (lado == 0) ? cx - r : cx + r;
+            if (columna < minCx || columna > maxCx) continue;
+            for (int j = iniY; j <= finY; j++) {
+                revisarCelda(coordenadas, columna, j, x, y, excluir, mejor, resultado);
+            }
+        }
+
+        // Todo producto de un anillo posterior está a más de r celdas de
+        // distancia en algún eje. Un octante termina si su mejor no supera
+        // esa cota o si su dirección dominante ya salió del rango ocupado.
+        double cota = Metrica::clave(r * tamCelda, 0.0);
+        bool terminado = true;
+        for (int o = 0; o < OCTANTES && terminado; o++) {
+            if (resultado[o] >= 0 && mejor[o] <= cota) continue;
+            bool agotado;
+            switch (o) {
+                case 0: case 7: agotado = cx + r > maxCx; break;
+                case 1: case 2: agotado = cy + r > maxCy; break;
+                case 3: case 4: agotado = cx - r < minCx; break;
+                default:        agotado = cy - r < minCy; break;
+            }
+            if (!agotado) terminado = false;
+        }
+        if (terminado) return;
+    }
+}
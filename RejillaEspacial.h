@@ -0,0 +1,74 @@
+#ifndef REJILLAESPACIAL_H
+#define REJILLAESPACIAL_H
+
+#include <vector>
+#include <unordered_map>
+#include "Coordenadas.h"
+
+// Rejilla uniforme de celdas cuadradas sobre los productos, para el modo
+// incremental del Grafo. A diferencia del árbol kd (que guarda los puntos
+// permutados en un arreglo contiguo) admite insertar, quitar y renombrar
+// productos en O(1); solo se guardan las celdas ocupadas. El tamaño de
+// celda se fija al construir (unos pocos productos por celda); cuando la
+// cantidad de productos cambia mucho conviene reconstruir (desbalanceada()).
+class RejillaEspacial {
+public:
+    // Conos de 45° alrededor de un punto. En las tres métricas de Metrica.h
+    // las aristas del MST que tocan un punto van al más cercano de algún
+    // octante, así que esos (a lo sumo 8) candidatos bastan para conectarlo.
+    static const int OCTANTES = 8;
+
+    RejillaEspacial();
+
+    // Reparte todos los productos en celdas, O(n)
+    void construir(const Coordenadas& coordenadas);
+
+    // Vacía la rejilla
+    void limpiar();
+
+    // Agrega, quita o cambia el índice de un producto ubicado en (x, y)
+    void insertar(int indice, double x, double y);
+    void quitar(int indice, double x, double y);
+    void renombrar(int viejo, int nuevo, double x, double y);
+
+    int size() const { return numPuntos; }
+
+    // La cantidad de productos se alejó mucho de la usada para elegir el
+    // tamaño de celda (las consultas recorrerían celdas muy llenas o muy vacías)
+    bool desbalanceada() const;
+
+    // En resultado[o] deja el producto más cercano a (x, y) dentro del
+    // octante o (-1 si no hay ninguno), omitiendo el índice excluir. Recorre
+    // anillos de celdas hacia afuera y se detiene cuando cada octante tiene
+    // su más cercano asegurado o ya no puede contener productos.
+    void masCercanosPorOctante(const Coordenadas& coordenadas, double x, double y,
+                               int excluir, int resultado[OCTANTES]) const;
+
+private:
+    typedef long long ClaveCelda;
+
+    // Productos esperados por celda al elegir el tamaño
+    static const int PUNTOS_POR_CELDA = 2;
+
+    double tamCelda;
+    std::unordered_map<ClaveCelda, std::vector<int> > celdas;
+    int numPuntos;
+    int puntosAlConstruir;
+
+    // Rango de celdas que alguna vez estuvo ocupado (no se achica al quitar)
+    int minCx, maxCx, minCy, maxCy;
+
+    int celda(double v) const;
+
+    // Actualizan los mejores por octante con los productos de una celda o
+    // de una lista
+    void revisarCelda(const Coordenadas& coordenadas, int cx, int cy, double x, double y,
+                      int excluir, double mejor[OCTANTES], int resultado[OCTANTES]) const;
+    void revisarPuntos(const Coordenadas& coordenadas, const std::vector<int>& lista, double x, double y,
+                       int excluir, double mejor[OCTANTES], int resultado[OCTANTES]) const;
+    static ClaveCelda clave(int cx, int cy) {
+        return ((ClaveCelda)cx << 32) ^ (ClaveCelda)(unsigned int)cy;
+    }
+};
+
+#endif
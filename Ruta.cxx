@@ -0,0 +1,44 @@
+#include "Ruta.h"
+
+double Ruta::medirDistancias(const Coordenadas& coordenadas,
+                             std::vector<double>* porViaje) const {
+    // Se suma tramo a tramo en el orden de la ruta para que el total coincida
+    // con el de recorrer la lista de paradas
+    double total = 0.0;
+    if (porViaje != 0) porViaje->assign(numViajes(), 0.0);
+
+    for (int t = 0; t < numViajes(); t++) {
+        double viaje = 0.0;
+        int anterior = -1;
+        for (int p = inicioViaje[t]; p < inicioViaje[t + 1]; p++) {
+            int actual = indices[p];
+            double tramo = (anterior < 0) ? coordenadas.distanciaA(actual, base.x, base.y)
+                                          : coordenadas.distancia(anterior, actual);
+            viaje += tramo;
+            total += tramo;
+            anterior = actual;
+        }
+        if (anterior >= 0) {
+            double tramo = coordenadas.distanciaA(anterior, base.x, base.y);
+            viaje += tramo;
+            total += tramo;
+        }
+        if (porViaje != 0) (*porViaje)[t] = viaje;
+    }
+    return total;
+}
+
+std::vector<Producto> Ruta::comoProductos(const Coordenadas& coordenadas) const {
+    std::vector<Producto> paradas;
+    if (numViajes() == 0) return paradas;
+
+    paradas.reserve(numParadas());
+    paradas.push_back(base);
+    for (int t = 0; t < numViajes(); t++) {
+        for (int p = inicioViaje[t]; p < inicioViaje[t + 1]; p++) {
+            paradas.push_back(coordenadas.producto(indices[p]));
+        }
+        paradas.push_back(base);
+    }
+    return paradas;
+}
@@ -0,0 +1,60 @@
+#ifndef RUTA_H
+#define RUTA_H
+
+#include <vector>
+#include "Coordenadas.h"
+
+// Ruta de un escenario como índices de productos con desplazamientos por
+// viaje (formato CSR): el viaje t sale de la base, visita
+// indices[inicioViaje[t]] .. indices[inicioViaje[t + 1] - 1] y vuelve a la
+// base. Un int por producto y uno por viaje, sin copiar coordenadas ni
+// repetir la base; los índices son posiciones en las Coordenadas del escenario.
+struct Ruta {
+    std::vector<int> indices;
+    std::vector<int> inicioViaje;        // numViajes() + 1 desplazamientos
+    std::vector<double> distanciaViaje;  // Base -> productos -> base, por viaje
+    double distanciaTotal;
+    Producto base;
+
+    Ruta() : inicioViaje(1, 0), distanciaTotal(0), base(0, 0, -1) {}
+
+    int numViajes() const { return (int)inicioViaje.size() - 1; }
+    int numProductos() const { return indices.size(); }
+
+    // Productos que recoge el viaje t (cada producto es una unidad de carga)
+    int carga(int t) const { return inicioViaje[t + 1] - inicioViaje[t]; }
+
+    // Paradas en el formato de salida: la base al inicio y tras cada viaje
+    int numParadas() const { return numViajes() > 0 ? numProductos() + numViajes() + 1 : 0; }
+
+    // Deja la ruta vacía conservando la memoria reservada
+    void limpiar(const Producto& nuevaBase) {
+        indices.clear();
+        inicioViaje.assign(1, 0);
+        distanciaViaje.clear();
+        distanciaTotal = 0;
+        base = nuevaBase;
+    }
+
+    // Construcción: agregar los productos de un viaje y luego cerrarlo
+    // (cerrar un viaje sin productos no hace nada)
+    void agregar(int indice) { indices.push_back(indice); }
+    void cerrarViaje() {
+        if ((int)indices.size() > inicioViaje.back()) inicioViaje.push_back(indices.size());
+    }
+
+    // Distancia total recorriendo los índices en una pasada; si porViaje no
+    // es nulo deja ahí la distancia de cada viaje
+    double medirDistancias(const Coordenadas& coordenadas,
+                           std::vector<double>* porViaje = 0) const;
+
+    // Llena distanciaViaje y distanciaTotal
+    void calcularDistancias(const Coordenadas& coordenadas) {
+        distanciaTotal = medirDistancias(coordenadas, &distanciaViaje);
+    }
+
+    // Lista de paradas con la base entre viajes (formato de salida)
+    std::vector<Producto> comoProductos(const Coordenadas& coordenadas) const;
+};
+
+#endif
@@ -0,0 +1,166 @@
+#include "Ruteo.h"
+#include <algorithm>
+#include <cmath>
+#include <queue>
+
+namespace {
+
+// Ahorro de unir los extremos i y j de dos viajes
+struct Ahorro {
+    double valor;
+    int i, j;
+    
+    Ahorro(double v, int a, int b) : valor(v), i(a), j(b) {}
+    
+    // Para priority_queue: mayor ahorro primero, empates por índices
+    bool operator<(const Ahorro& otro) const {
+        if (valor != otro.valor) return valor < otro.valor;
+        if (i != otro.i) return i > otro.i;
+        return j > otro.j;
+    }
+};
+
+int buscarRaiz(std::vector<int>& padre, int x) {
+    while (padre[x] != x) {
+        padre[x] = padre[padre[x]];
+        x = padre[x];
+    }
+    return x;
+}
+
+// Ordena un viaje por vecino más cercano partiendo de la base (compara
+// claves de distancia, sin raíz)
+void ordenarVecinoMasCercano(const Coordenadas& coordenadas, const Producto& base,
+                             std::vector<int>& viaje) {
+    double x = base.x;
+    double y = base.y;
+    for (size_t i = 0; i < viaje.size(); i++) {
+        size_t mejor = i;
+        double mejorClave = coordenadas.claveA(viaje[i], x, y);
+        for (size_t j = i + 1; j < viaje.size(); j++) {
+            double clave = coordenadas.claveA(viaje[j], x, y);
+            if (clave < mejorClave) {
+                mejorClave = clave;
+                mejor = j;
+            }
+        }
+        std::swap(viaje[i], viaje[mejor]);
+        x = coordenadas.x(viaje[i]);
+        y = coordenadas.y(viaje[i]);
+    }
+}
+
+}
+
+// ============================================
+// AHORROS DE CLARKE-WRIGHT
+// ============================================
+std::vector<std::vector<int> > viajesAhorros(const Coordenadas& coordenadas,
+                                             const Producto& base, int capacidad,
+                                             const std::vector<int>& vecinos, int numVecinos) {
+    int n = coordenadas.size();
+    std::vector<std::vector<int> > viajes;
+    if (n == 0) return viajes;
+    
+    // Cada viaje es un camino: enlaces[2u], enlaces[2u+1] son los vecinos
+    // de u dentro de su viaje (-1 si no hay). u es extremo si le falta alguno.
+    std::vector<int> enlaces(2 * n, -1);
+    std::vector<int> padre(n);
+    std::vector<int> carga(n, 1);
+    for (int i = 0; i < n; i++) {
+        padre[i] = i;
+    }
+    
+    // Un par puede entrar dos veces (si cada uno es vecino del otro); la
+    // segunda vez se descarta sola porque ya están en el mismo viaje o
+    // porque la fusión ya había fallado por capacidad
+    std::priority_queue<Ahorro> heap;
+    for (int i = 0; i < n; i++) {
+        double di = base.distanciaA(coordenadas.producto(i));
+        for (int t = 0; t < numVecinos; t++) {
+            int j = vecinos[(size_t)i * numVecinos + t];
+            if (j < 0) continue;
+            double valor = di + base.distanciaA(coordenadas.producto(j)) - coordenadas.distancia(i, j);
+            if (valor > 0) heap.push(Ahorro(valor, std::min(i, j), std::max(i, j)));
+        }
+    }
+    
+    while (!heap.empty()) {
+        Ahorro ahorro = heap.top();
+        heap.pop();
+        int i = ahorro.i;
+        int j = ahorro.j;
+        
+        // Ambos deben ser extremos de viajes distintos
+        if (enlaces[2 * i + 1] >= 0 || enlaces[2 * j + 1] >= 0) continue;
+        int ri = buscarRaiz(padre, i);
+        int rj = buscarRaiz(padre, j);
+        if (ri == rj || carga[ri] + carga[rj] > capacidad) continue;
+        
+        enlaces[2 * i + (enlaces[2 * i] >= 0 ? 1 : 0)] = j;
+        enlaces[2 * j + (enlaces[2 * j] >= 0 ? 1 : 0)] = i;
+        padre[rj] = ri;
+        carga[ri] += carga[rj];
+    }
+    
+    // Recorrer cada camino desde uno de sus extremos
+    std::vector<bool> visitado(n, false);
+    for (int u = 0; u < n; u++) {
+        if (visitado[u] || enlaces[2 * u + 1] >= 0) continue;
+        std::vector<int> viaje;
+        int anterior = -1;
+        int actual = u;
+        while (actual >= 0) {
+            visitado[actual] = true;
+            viaje.push_back(actual);
+            int siguiente = (enlaces[2 * actual] != anterior) ? enlaces[2 * actual] : enlaces[2 * actual + 1];
+            anterior = actual;
+            actual = siguiente;
+        }
+        viajes.push_back(viaje);
+    }
+    
+    return viajes;
+}
+
+// ============================================
+// BARRIDO POLAR
+// ============================================
+std::vector<std::vector<int> > viajesBarrido(const Coordenadas& coordenadas,
+                                             const Producto& base, int capacidad) {
+    int n = coordenadas.size();
+    std::vector<std::vector<int> > viajes;
+    if (n == 0 || capacidad <= 0) return viajes;
+    
+    // (ángulo, distancia, índice) alrededor de la base
+    std::vector<std::pair<std::pair<double, double>, int> > orden(n);
+    for (int i = 0; i < n; i++) {
+        double dx = coordenadas.x(i) - base.x;
+        double dy = coordenadas.y(i) - base.y;
+        orden[i] = std::make_pair(std::make_pair(std::atan2(dy, dx), Metrica::clave(dx, dy)), i);
+    }
+    std::sort(orden.begin(), orden.end());
+    
+    // Empezar justo después del mayor hueco angular (contando el cierre)
+    const double DOS_PI = 2.0 * std::acos(-1.0);
+    int inicio = 0;
+    double mayorHueco = orden[0].first.first + DOS_PI - orden[n - 1].first.first;
+    for (int i = 1; i < n; i++) {
+        double hueco = orden[i].first.first - orden[i - 1].first.first;
+        if (hueco > mayorHueco) {
+            mayorHueco = hueco;
+            inicio = i;
+        }
+    }
+    
+    for (int t = 0; t < n; t += capacidad) {
+        std::vector<int> viaje;
+        for (int i = t; i < n && i < t + capacidad; i++) {
+            viaje.push_back(orden[(inicio + i) % n].second);
+        }
+        ordenarVecinoMasCercano(coordenadas, base, viaje);
+        viajes.push_back(viaje);
+    }
+    
+    return viajes;
+}
@@ -0,0 +1,30 @@
+#ifndef RUTEO_H
+#define RUTEO_H
+
+#include <vector>
+#include "Coordenadas.h"
+
+// Motor que arma los viajes con restricción de capacidad
+enum MotorRuteo {
+    RUTEO_MST,     // Preorden del MST cortado en viajes (Prim + DFS)
+    RUTEO_AHORROS, // Ahorros de Clarke-Wright sobre vecinos cercanos
+    RUTEO_BARRIDO  // Barrido polar desde la base
+};
+
+// Clarke-Wright: parte de un viaje por producto y fusiona extremos de
+// viajes en orden decreciente de ahorro d(0,i) + d(0,j) - d(i,j) mientras la
+// carga no supere la capacidad. Solo se consideran los pares (i, j) con j
+// entre los numVecinos más cercanos de i (vecinos[i * numVecinos + t], -1
+// si faltan), así el heap tiene O(n) ahorros en lugar de O(n²).
+std::vector<std::vector<int> > viajesAhorros(const Coordenadas& coordenadas,
+                                             const Producto& base, int capacidad,
+                                             const std::vector<int>& vecinos, int numVecinos);
+
+// Barrido: ordena los productos por ángulo polar alrededor de la base,
+// empezando tras el mayor hueco angular, y corta la secuencia en viajes de
+// capacidad productos. Cada viaje se ordena por vecino más cercano desde
+// la base, O(n·capacidad) en total.
+std::vector<std::vector<int> > viajesBarrido(const Coordenadas& coordenadas,
+                                             const Producto& base, int capacidad);
+
+#endif
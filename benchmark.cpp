@@ -0,0 +1,439 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <iomanip>
+#include <string>
+#include <cmath>
+#include <cstdlib>
+#include <chrono>
+#include <random>
+#include <sys/resource.h>
+#include "Grafo.h"
+#include "PoolHilos.h"
+
+using namespace std;
+
+// Banco de pruebas: genera escenarios sintéticos reproducibles, los resuelve
+// y reporta el tiempo de cada etapa, el rendimiento, la memoria pico y la
+// distancia de la ruta en CSV o JSON.
+
+// ============================================================================
+// GENERADORES SINTÉTICOS
+// ============================================================================
+
+// Números aleatorios idénticos en cualquier plataforma: mt19937_64 está
+// definido por el estándar, pero las distribuciones de <random> no
+class Aleatorio {
+public:
+    explicit Aleatorio(unsigned long long semilla) : motor(semilla) {}
+    
+    // Uniforme en [0, 1)
+    double uniforme() { return (motor() >> 11) * (1.0 / 9007199254740992.0); }
+    
+    // Entero uniforme en [0, n)
+    long long entero(long long n) { return (long long)(uniforme() * n); }
+    
+    // Normal estándar (Box-Muller)
+    double normal() {
+        double u = 1.0 - uniforme();
+        double v = uniforme();
+        return sqrt(-2.0 * log(u)) * cos(2.0 * M_PI * v);
+    }
+
+private:
+    std::mt19937_64 motor;
+};
+
+enum Generador {
+    GENERADOR_UNIFORME,  // Puntos uniformes en un cuadrado
+    GENERADOR_AGRUPADO,  // Nubes gaussianas alrededor de centros al azar
+    GENERADOR_PASILLOS,  // Estanterías en pasillos paralelos (posiciones discretas)
+    GENERADOR_CAMINO     // Caminata aleatoria suave: MST muy profundo
+};
+
+const char* nombreGenerador(Generador g) {
+    switch (g) {
+        case GENERADOR_UNIFORME: return "uniforme";
+        case GENERADOR_AGRUPADO: return "agrupado";
+        case GENERADOR_PASILLOS: return "pasillos";
+        default: return "camino";
+    }
+}
+
+// Genera m productos (x0 y0 x1 y1 ...) con densidad aproximadamente constante
+void generarEscenario(Generador generador, int m, unsigned long long semilla,
+                      vector<double>& coordenadas) {
+    Aleatorio aleatorio(semilla);
+    double lado = 10.0 * sqrt((double)max(m, 1));
+    coordenadas.resize(2 * (size_t)m);
+    
+    if (generador == GENERADOR_UNIFORME) {
+        for (int i = 0; i < m; i++) {
+            coordenadas[2 * i] = aleatorio.uniforme() * lado;
+            coordenadas[2 * i + 1] = aleatorio.uniforme() * lado;
+        }
+    } else if (generador == GENERADOR_AGRUPADO) {
+        int numGrupos = max(1, (int)sqrt((double)m) / 2);
+        double sigma = lado / (4.0 * sqrt((double)numGrupos));
+        vector<double> centros(2 * numGrupos);
+        for (int c = 0; c < 2 * numGrupos; c++) {
+            centros[c] = aleatorio.uniforme() * lado;
+        }
+        for (int i = 0; i < m; i++) {
+            int c = aleatorio.entero(numGrupos);
+            coordenadas[2 * i] = fabs(centros[2 * c] + sigma * aleatorio.normal());
+            coordenadas[2 * i + 1] = fabs(centros[2 * c + 1] + sigma * aleatorio.normal());
+        }
+    } else if (generador == GENERADOR_PASILLOS) {
+        // Pasillos de 3 m con estanterías a ambos lados y huecos de 1 m
+        int numPasillos = max(1, (int)ceil(sqrt(m / 8.0)));
+        int huecosPorLado = max(1, (int)ceil((double)m / (2.0 * numPasillos)));
+        for (int i = 0; i < m; i++) {
+            int pasillo = aleatorio.entero(numPasillos);
+            int cara = aleatorio.entero(2);
+            int hueco = aleatorio.entero(huecosPorLado);
+            coordenadas[2 * i] = 2.0 + pasillo * 5.0 + cara * 3.0;
+            coordenadas[2 * i + 1] = 2.0 + hueco * 1.0;
+        }
+    } else {
+        double x = 0, y = 0, rumbo = aleatorio.uniforme() * M_PI / 2;
+        for (int i = 0; i < m; i++) {
+            rumbo += 0.3 * aleatorio.normal();
+            x += cos(rumbo);
+            y += sin(rumbo);
+            coordenadas[2 * i] = x;
+            coordenadas[2 * i + 1] = y;
+        }
+    }
+}
+
+// ============================================================================
+// MEDICIÓN
+// ============================================================================
+
+typedef chrono::steady_clock Reloj;
+
+double msDesde(Reloj::time_point inicio) {
+    return chrono::duration<double, milli>(Reloj::now() - inicio).count();
+}
+
+// Reinicia el pico de memoria residente del proceso (Linux >= 4.0); si no es
+// posible, el pico reportado es el de todo el proceso hasta ese momento
+void reiniciarMemoriaPico() {
+    ofstream refs("/proc/self/clear_refs");
+    if (refs.is_open()) refs << "5";
+}
+
+// Memoria residente pico en MB
+double memoriaPicoMB() {
+    ifstream estado("/proc/self/status");
+    string linea;
+    while (getline(estado, linea)) {
+        if (linea.compare(0, 6, "VmHWM:") == 0) {
+            return atof(linea.c_str() + 6) / 1024.0;
+        }
+    }
+    struct rusage uso;
+    getrusage(RUSAGE_SELF, &uso);
+    return uso.ru_maxrss / 1024.0;
+}
+
+struct Medicion {
+    Generador generador;
+    int m;
+    int k;
+    double cargaMs;
+    TiemposEtapas etapas;
+    double distanciaTotalMs;
+    double totalMs;
+    double memoriaMB;
+    double distancia;
+    double cambioMs; // Promedio por cambio incremental (0 sin --cambios)
+    int viajes;
+};
+
+// Resuelve el escenario desde cero con un Grafo nuevo; con cambios > 0
+// después aplica esa cantidad de altas y bajas en modo incremental
+Medicion medir(Generador generador, int m, int k, const vector<double>& coordenadas,
+               MotorRuteo motor, double presupuestoMejora, double plazo, int hilosMST,
+               int cambios) {
+    Medicion medicion;
+    medicion.generador = generador;
+    medicion.m = m;
+    medicion.k = k;
+    
+    reiniciarMemoriaPico();
+    Reloj::time_point inicio = Reloj::now();
+    
+    Grafo grafo(k);
+    grafo.setMotorRuteo(motor);
+    grafo.setPresupuestoMejora(presupuestoMejora);
+    grafo.setPlazo(plazo);
+    grafo.setHilosMST(hilosMST);
+    grafo.reservarProductos(m);
+    for (int i = 0; i < m; i++) {
+        grafo.agregarProducto(coordenadas[2 * i], coordenadas[2 * i + 1]);
+    }
+    medicion.cargaMs = msDesde(inicio);
+    
+    const Ruta& ruta = grafo.obtenerRuta();
+    medicion.etapas = grafo.getTiemposEtapas();
+    
+    Reloj::time_point inicioDistancia = Reloj::now();
+    medicion.distancia = grafo.calcularDistanciaTotal(ruta);
+    medicion.distanciaTotalMs = msDesde(inicioDistancia);
+    
+    medicion.totalMs = msDesde(inicio);
+    medicion.memoriaMB = memoriaPicoMB();
+    medicion.viajes = ruta.numViajes();
+    
+    // Pedidos que llegan y se cancelan: alternar un producto nuevo junto a
+    // uno existente y la baja de un producto al azar
+    medicion.cambioMs = 0;
+    if (cambios > 0) {
+        grafo.setModoIncremental(true);
+        Aleatorio aleatorio(m + 7919ULL * k);
+        Reloj::time_point inicioCambios = Reloj::now();
+        for (int c = 0; c < cambios; c++) {
+            if (c % 2 == 0 || grafo.getNumProductos() == 0) {
+                int j = aleatorio.entero(m);
+                grafo.agregarProducto(coordenadas[2 * j] + 0.5, coordenadas[2 * j + 1] + 0.5);
+            } else {
+                grafo.eliminarProducto(aleatorio.entero(grafo.getNumProductos()));
+            }
+        }
+        medicion.cambioMs = msDesde(inicioCambios) / cambios;
+    }
+    return medicion;
+}
+
+// ============================================================================
+// REPORTE
+// ============================================================================
+
+const char* CAMPOS[] = {
+    "generador", "m", "k", "carga_ms", "indice_ms", "distancias_ms", "mst_ms",
+    "recorrido_ms", "viajes_ms", "mejora_ms", "distancia_total_ms", "total_ms",
+    "productos_por_s", "memoria_pico_mb", "distancia", "cambio_ms", "viajes"
+};
+const int NUM_CAMPOS = sizeof(CAMPOS) / sizeof(CAMPOS[0]);
+
+// Valores de una medición en el orden de CAMPOS (texto ya formateado)
+vector<string> valores(const Medicion& r) {
+    double numeros[] = {
+        r.cargaMs, r.etapas.indice, r.etapas.distancias, r.etapas.mst,
+        r.etapas.recorrido, r.etapas.viajes, r.etapas.mejora, r.distanciaTotalMs, r.totalMs,
+        r.totalMs > 0 ? r.m / (r.totalMs / 1000.0) : 0.0, r.memoriaMB, r.distancia, r.cambioMs
+    };
+    vector<string> v;
+    v.push_back(nombreGenerador(r.generador));
+    ostringstream texto;
+    texto << r.m;
+    v.push_back(texto.str());
+    texto.str("");
+    texto << r.k;
+    v.push_back(texto.str());
+    for (size_t i = 0; i < sizeof(numeros) / sizeof(numeros[0]); i++) {
+        texto.str("");
+        texto << fixed << setprecision(3) << numeros[i];
+        v.push_back(texto.str());
+    }
+    texto.str("");
+    texto << r.viajes;
+    v.push_back(texto.str());
+    return v;
+}
+
+void escribirCSV(ostream& salida, const vector<Medicion>& mediciones) {
+    for (int c = 0; c < NUM_CAMPOS; c++) {
+        salida << (c > 0 ? "," : "") << CAMPOS[c];
+    }
+    salida << "\n";
+    for (size_t i = 0; i < mediciones.size(); i++) {
+        vector<string> v = valores(mediciones[i]);
+        for (int c = 0; c < NUM_CAMPOS; c++) {
+            salida << (c > 0 ? "," : "") << v[c];
+        }
+        salida << "\n";
+    }
+}
+
+void escribirJSON(ostream& salida, const vector<Medicion>& mediciones) {
+    salida << "[\n";
+    for (size_t i = 0; i < mediciones.size(); i++) {
+        vector<string> v = valores(mediciones[i]);
+        salida << "  {";
+        for (int c = 0; c < NUM_CAMPOS; c++) {
+            salida << (c > 0 ? ", " : "") << "\"" << CAMPOS[c] << "\": ";
+            if (c == 0) salida << "\"" << v[c] << "\"";
+            else salida << v[c];
+        }
+        salida << "}" << (i + 1 < mediciones.size() ? "," : "") << "\n";
+    }
+    salida << "]\n";
+}
+
+// ============================================================================
+// PRUEBA DE ESTRÉS DEL POOL DE HILOS
+// ============================================================================
+
+// Más hilos que núcleos: así hay hilos que despiertan tarde, cuando su ronda
+// ya terminó y la siguiente está llenando las colas
+const int HILOS_ESTRES = 8;
+
+// Muchas rondas seguidas sobre un mismo pool (como Borůvka, que llama a
+// ejecutar() varias veces por MST): cada tarea debe correr exactamente una
+// vez por ronda. Luego el MST de varios escenarios seguidos con un mismo
+// pool debe pesar lo mismo que el secuencial. Devuelve 0 si todo coincide.
+int estresPool(int rondas, unsigned long long semilla) {
+    PoolHilos pool(HILOS_ESTRES);
+    const int MAX_TAREAS = 64;
+    vector<int> ejecuciones(MAX_TAREAS);
+    Reloj::time_point inicio = Reloj::now();
+    for (int r = 0; r < rondas; r++) {
+        int numTareas = 1 + r % MAX_TAREAS;
+        for (int i = 0; i < numTareas; i++) ejecuciones[i] = 0;
+        // Cada índice lo toca un solo hilo; ejecutar() ordena las escrituras
+        pool.ejecutar(numTareas, [&](int i, int) { ejecuciones[i]++; });
+        for (int i = 0; i < numTareas; i++) {
+            if (ejecuciones[i] != 1) {
+                cerr << "Error: ronda " << r << ", tarea " << i << " ejecutada "
+                     << ejecuciones[i] << " veces" << endl;
+                return 1;
+            }
+        }
+    }
+    cerr << "  " << rondas << " rondas del pool: " << fixed << setprecision(1)
+         << msDesde(inicio) << " ms" << endl;
+    
+    const int ESCENARIOS = 8;
+    const int PRODUCTOS = 20000; // Borůvka en cualquier configuración
+    vector<double> coordenadas;
+    Grafo paralelo(1), secuencial(1);
+    paralelo.setMotorMST(MST_BORUVKA_KD);
+    secuencial.setMotorMST(MST_BORUVKA_KD);
+    paralelo.usarPoolMST(&pool);
+    for (int e = 0; e < ESCENARIOS; e++) {
+        generarEscenario(GENERADOR_AGRUPADO, PRODUCTOS, semilla + e, coordenadas);
+        paralelo.limpiar();
+        secuencial.limpiar();
+        for (int i = 0; i < PRODUCTOS; i++) {
+            paralelo.agregarProducto(coordenadas[2 * i], coordenadas[2 * i + 1]);
+            secuencial.agregarProducto(coordenadas[2 * i], coordenadas[2 * i + 1]);
+        }
+        const vector<Arista>& mstParalelo = paralelo.obtenerMST();
+        const vector<Arista>& mstSecuencial = secuencial.obtenerMST();
+        double pesoParalelo = 0, pesoSecuencial = 0;
+        for (size_t i = 0; i < mstParalelo.size(); i++) pesoParalelo += mstParalelo[i].peso;
+        for (size_t i = 0; i < mstSecuencial.size(); i++) pesoSecuencial += mstSecuencial[i].peso;
+        if (mstParalelo.size() != mstSecuencial.size() ||
+            fabs(pesoParalelo - pesoSecuencial) > 1e-9 * pesoSecuencial) {
+            cerr << "Error: escenario " << e << ", el MST con el pool pesa " << pesoParalelo
+                 << " y el secuencial " << pesoSecuencial << endl;
+            return 1;
+        }
+    }
+    cerr << "  " << ESCENARIOS << " MST de " << PRODUCTOS << " productos con el pool persistente: ok"
+         << endl;
+    return 0;
+}
+
+// Indica si arg es la opción "--nombre=valor" y en ese caso deja el valor
+bool leerOpcion(const string& arg, const string& nombre, string& valor) {
+    string prefijo = "--" + nombre + "=";
+    if (arg.compare(0, prefijo.size(), prefijo) != 0) return false;
+    valor = arg.substr(prefijo.size());
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    int maximo = 1000000;
+    bool json = false;
+    string archivoSalida;
+    unsigned long long semilla = 12345;
+    double presupuestoMejora = 0;
+    double plazo = 0;
+    MotorRuteo motor = RUTEO_MST;
+    int hilosMST = 1;
+    int cambios = 0;
+    int rondasEstres = 0; // 0 = banco de pruebas normal
+    
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        string valor;
+        if (leerOpcion(arg, "max", valor)) {
+            maximo = atoi(valor.c_str());
+        } else if (leerOpcion(arg, "formato", valor) && (valor == "csv" || valor == "json")) {
+            json = (valor == "json");
+        } else if (leerOpcion(arg, "salida", valor)) {
+            archivoSalida = valor;
+        } else if (leerOpcion(arg, "semilla", valor)) {
+            semilla = strtoull(valor.c_str(), 0, 10);
+        } else if (leerOpcion(arg, "mejora", valor)) {
+            presupuestoMejora = atof(valor.c_str());
+        } else if (leerOpcion(arg, "plazo", valor)) {
+            plazo = atof(valor.c_str());
+        } else if (leerOpcion(arg, "motor", valor) && (valor == "mst" || valor == "ahorros" ||
+                                                       valor == "barrido")) {
+            motor = valor == "mst" ? RUTEO_MST : valor == "ahorros" ? RUTEO_AHORROS : RUTEO_BARRIDO;
+        } else if (leerOpcion(arg, "hilos-mst", valor)) {
+            hilosMST = atoi(valor.c_str());
+        } else if (leerOpcion(arg, "cambios", valor)) {
+            cambios = atoi(valor.c_str());
+        } else if (leerOpcion(arg, "estres-pool", valor) && atoi(valor.c_str()) > 0) {
+            rondasEstres = atoi(valor.c_str());
+        } else {
+            cerr << "Uso: " << argv[0] << " [opciones]" << endl;
+            cerr << "  --max=N            Tamano maximo de escenario (defecto 1000000)" << endl;
+            cerr << "  --formato=F        csv (defecto) o json" << endl;
+            cerr << "  --salida=ARCHIVO   Escribe el reporte en ARCHIVO en vez de la consola" << endl;
+            cerr << "  --semilla=S        Semilla de los generadores (defecto 12345)" << endl;
+            cerr << "  --mejora=MS        Presupuesto de mejora local por escenario" << endl;
+            cerr << "  --motor=M          mst (defecto), ahorros o barrido" << endl;
+            cerr << "  --plazo=MS         Resolucion con plazo por escenario (ignora --motor y --mejora)" << endl;
+            cerr << "  --hilos-mst=N      Hilos del MST de escenarios grandes (defecto 1; 0 = todos)" << endl;
+            cerr << "  --cambios=N        Tras resolver, N altas/bajas incrementales (reporta cambio_ms)" << endl;
+            cerr << "  --estres-pool=R    Solo la prueba de estres del pool de hilos: R rondas" << endl;
+            cerr << "                     seguidas y MST con un pool persistente" << endl;
+            return 1;
+        }
+    }
+    
+    if (rondasEstres > 0) return estresPool(rondasEstres, semilla);
+    
+    const Generador generadores[] = {
+        GENERADOR_UNIFORME, GENERADOR_AGRUPADO, GENERADOR_PASILLOS, GENERADOR_CAMINO
+    };
+    const int capacidades[] = {3, 20, 100};
+    
+    vector<Medicion> mediciones;
+    vector<double> coordenadas;
+    for (int g = 0; g < 4; g++) {
+        for (int m = 10; m <= maximo; m *= 10) {
+            // Misma semilla por (generador, tamaño): resultados comparables entre corridas
+            generarEscenario(generadores[g], m, semilla + 1000003ULL * g + m, coordenadas);
+            for (int c = 0; c < 3; c++) {
+                mediciones.push_back(medir(generadores[g], m, capacidades[c], coordenadas,
+                                           motor, presupuestoMejora, plazo, hilosMST, cambios));
+                cerr << "  " << nombreGenerador(generadores[g]) << " m=" << m
+                     << " k=" << capacidades[c] << ": " << fixed << setprecision(1)
+                     << mediciones.back().totalMs << " ms" << endl;
+            }
+        }
+    }
+    
+    if (archivoSalida.empty()) {
+        if (json) escribirJSON(cout, mediciones);
+        else escribirCSV(cout, mediciones);
+    } else {
+        ofstream salida(archivoSalida.c_str());
+        if (!salida.is_open()) {
+            cerr << "Error: No se pudo crear el archivo " << archivoSalida << endl;
+            return 1;
+        }
+        if (json) escribirJSON(salida, mediciones);
+        else escribirCSV(salida, mediciones);
+    }
+    return 0;
+}
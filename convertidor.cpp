@@ -0,0 +1,120 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <iomanip>
+#include <string>
+#include "LectorEscenarios.h"
+#include "FormatoBinario.h"
+
+using namespace std;
+
+// Convierte entre el formato de texto y el binario. La dirección se deduce
+// de la entrada: un archivo de texto de escenarios pasa a binario, y un
+// archivo binario (de escenarios o de rutas) pasa a texto.
+
+// Texto de escenarios -> binario de escenarios
+int textoABinario(const string& archivoEntrada, const string& archivoSalida) {
+    LectorEscenarios entrada;
+    if (!entrada.abrir(archivoEntrada)) {
+        cerr << "Error: No se pudo abrir el archivo " << archivoEntrada << endl;
+        return 1;
+    }
+    
+    int n;
+    if (!entrada.leerEntero(n) || n < 0) {
+        cerr << "Error: " << (entrada.getError().empty() ? "numero de escenarios invalido"
+                                                          : entrada.getError()) << endl;
+        return 1;
+    }
+    
+    EscritorBinario salida;
+    if (!salida.abrir(archivoSalida, BINARIO_ESCENARIOS)) {
+        cerr << "Error: No se pudo crear el archivo " << archivoSalida << endl;
+        return 1;
+    }
+    
+    vector<double> coordenadas;
+    for (int e = 0; e < n; e++) {
+        int k, m;
+        if (!entrada.leerCabecera(k, m) || !entrada.leerCoordenadas(m, coordenadas)) {
+            cerr << "Error: Escenario " << (e + 1) << ", " << entrada.getError() << endl;
+            return 1;
+        }
+        if (!salida.agregarEscenario(k, coordenadas)) {
+            cerr << "Error: No se pudo escribir el archivo " << archivoSalida << endl;
+            return 1;
+        }
+    }
+    if (!salida.cerrar()) {
+        cerr << "Error: No se pudo escribir el archivo " << archivoSalida << endl;
+        return 1;
+    }
+    
+    cout << "  " << n << " escenarios convertidos a binario" << endl;
+    return 0;
+}
+
+// Binario -> texto (escenarios en el formato de entrada, rutas en el de salida)
+int binarioATexto(const string& archivoEntrada, const string& archivoSalida) {
+    ArchivoBinario entrada;
+    if (!entrada.abrir(archivoEntrada)) {
+        cerr << "Error: " << archivoEntrada << ": " << entrada.getError() << endl;
+        return 1;
+    }
+    
+    ofstream salida(archivoSalida);
+    if (!salida.is_open()) {
+        cerr << "Error: No se pudo crear el archivo " << archivoSalida << endl;
+        return 1;
+    }
+    
+    size_t n = entrada.getNumRegistros();
+    salida << n << endl;
+    for (size_t e = 0; e < n; e++) {
+        RegistroBinario registro = entrada.registro(e);
+        
+        if (entrada.getTipo() == BINARIO_ESCENARIOS) {
+            salida << registro.k << " " << registro.m << endl;
+            for (size_t i = 0; i < registro.m; i++) {
+                // 17 cifras significativas: la conversión de ida y vuelta es exacta
+                salida << setprecision(17) << registro.xs[i] << " " << registro.ys[i] << endl;
+            }
+            continue;
+        }
+        
+        // Ruta: base, productos de cada viaje y regreso a la base (vacía sin viajes)
+        salida << registro.k << endl;
+        salida << (registro.numViajes == 0 ? 0 : registro.m + registro.numViajes + 1) << endl;
+        if (registro.numViajes == 0) continue;
+        salida << fixed << setprecision(2) << 0.0 << " " << 0.0 << endl;
+        for (size_t t = 0; t < registro.numViajes; t++) {
+            for (size_t j = registro.inicioViaje[t]; j < registro.inicioViaje[t + 1]; j++) {
+                unsigned i = registro.indices[j];
+                salida << registro.xs[i] << " " << registro.ys[i] << endl;
+            }
+            salida << 0.0 << " " << 0.0 << endl;
+        }
+        salida.unsetf(ios::floatfield);
+    }
+    
+    cout << "  " << n << (entrada.getTipo() == BINARIO_ESCENARIOS ? " escenarios convertidos"
+                                                                  : " rutas convertidas")
+         << " a texto" << endl;
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc != 3) {
+        cerr << "Uso: " << argv[0] << " <entrada> <salida>" << endl;
+        cerr << "  Texto de escenarios -> binario, o binario (escenarios o rutas) -> texto" << endl;
+        return 1;
+    }
+    
+    string archivoEntrada = argv[1];
+    string archivoSalida = argv[2];
+    
+    if (ArchivoBinario::esBinario(archivoEntrada)) {
+        return binarioATexto(archivoEntrada, archivoSalida);
+    }
+    return textoABinario(archivoEntrada, archivoSalida);
+}
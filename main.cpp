@@ -2,11 +2,36 @@
 #include <fstream>
 #include <vector>
 #include <iomanip>
+#include <sstream>
 #include <string>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+#include <cstring>
+#include <chrono>
+#include <csignal>
+#include <cerrno>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
 #include "Grafo.h"
+#include "PoolHilos.h"
+#include "LectorEscenarios.h"
+#include "FormatoBinario.h"
+#include "EscritorSalida.h"
 
 using namespace std;
 
+// Entradas de la cache de rutas con --cache-archivo sin --cache
+const size_t ENTRADAS_CACHE_DEFECTO = 4096;
+
+// Cantidad de información que se muestra por consola
+enum Verbosidad {
+    VERBOSIDAD_SILENCIO,  // Nada (solo errores)
+    VERBOSIDAD_RESUMEN,   // Una línea al terminar
+    VERBOSIDAD_COMPLETA   // Detalle de cada escenario
+};
+
 // Función para generar nombre de archivo de salida
 string generarNombreSalida(const string& archivoEntrada) {
     // Buscar la última posición del punto
@@ -21,181 +46,914 @@ string generarNombreSalida(const string& archivoEntrada) {
     }
 }
 
-int main(int argc, char* argv[]) {
-    // Verificar argumentos
-    if (argc < 2) {
-        cerr << "Uso: " << argv[0] << " <archivo_entrada> [archivo_salida]" << endl;
-        cerr << "Ejemplo: " << argv[0] << " test_input.txt" << endl;
-        cerr << "         " << argv[0] << " test_input.txt resultado.txt" << endl;
-        return 1;
+// Indica si arg es la opción "--nombre=valor" y en ese caso deja el valor
+bool leerOpcion(const string& arg, const string& nombre, string& valor) {
+    string prefijo = "--" + nombre + "=";
+    if (arg.compare(0, prefijo.size(), prefijo) != 0) return false;
+    valor = arg.substr(prefijo.size());
+    return true;
+}
+
+// Escribe las métricas de un escenario como un objeto JSON en una línea
+void escribirMetricas(ostream& metricas, int escenario, int k, int m, double distancia,
+                      double tiempoMs, const TiemposEtapas& etapas,
+                      const ContadoresGrafo& contadores) {
+    metricas << fixed << setprecision(3)
+             << "{\"escenario\": " << escenario << ", \"k\": " << k << ", \"m\": " << m
+             << ", \"distancia\": " << distancia << ", \"tiempo_ms\": " << tiempoMs
+             << ", \"etapas_ms\": {\"indice\": " << etapas.indice
+             << ", \"distancias\": " << etapas.distancias << ", \"mst\": " << etapas.mst
+             << ", \"recorrido\": " << etapas.recorrido << ", \"viajes\": " << etapas.viajes
+             << ", \"mejora\": " << etapas.mejora << "}"
+             << ", \"contadores\": {\"evaluaciones_distancia\": " << contadores.evaluacionesDistancia
+             << ", \"inserciones_heap\": " << contadores.insercionesHeap
+             << ", \"extracciones_heap\": " << contadores.extraccionesHeap
+             << ", \"visitas_dfs\": " << contadores.visitasDFS
+             << ", \"consultas_indice\": " << contadores.consultasIndice
+             << ", \"viajes\": " << contadores.viajes << "}}\n";
+}
+
+// Con bodega, todos los productos deben estar en sus ubicaciones: informa
+// el primero que no lo está y devuelve false
+bool verificarBodega(const Bodega* bodega, const Coordenadas& coordenadas, int escenario) {
+    if (bodega == 0) return true;
+    for (int i = 0; i < (int)coordenadas.size(); i++) {
+        if (bodega->ubicacionEn(coordenadas.x(i), coordenadas.y(i)) < 0) {
+            cerr << "Error: Escenario " << escenario << ", producto " << (i + 1) << " ("
+                 << coordenadas.x(i) << ", " << coordenadas.y(i)
+                 << ") fuera de las ubicaciones de la bodega" << endl;
+            return false;
+        }
     }
+    return true;
+}
+
+// Contexto de la cache de rutas: todo lo que cambia la ruta de un escenario
+// salvo sus productos (los hilos del MST no cambian el árbol)
+string contextoCache(MotorRuteo motor, double presupuestoMejora, double plazo,
+                     const Bodega* bodega) {
+    ostringstream contexto;
+    contexto << "motor=" << motor << " mejora=" << presupuestoMejora << " plazo=" << plazo
+             << " metrica=" << Metrica::nombre();
+    if (bodega != 0) contexto << " bodega=" << bodega->getHuella();
+    return contexto.str();
+}
+
+// Una línea con el uso de la cache de rutas
+void mostrarCache(ostream& salida, CacheRutas& cache) {
+    salida << "Cache de rutas: " << cache.getAciertos() << " aciertos, " << cache.getFallos()
+           << " fallos, " << cache.numEntradas() << " entradas (" << cache.getDescartes()
+           << " descartadas)" << endl;
+}
+
+// Modo normal: lee, resuelve y (en verbosidad completa) muestra cada
+// escenario en orden; con metricas no nulo escribe además sus métricas
+int procesarSecuencial(LectorEscenarios& entrada, EscritorSalida& salida, int n,
+                       double presupuestoMejora, double plazo, MotorRuteo motor, int hilosMST,
+                       const Bodega* bodega, CacheRutas* cache, Verbosidad verbosidad,
+                       ostream* metricas, double& distanciaLote) {
+    bool completo = (verbosidad == VERBOSIDAD_COMPLETA);
+    distanciaLote = 0;
     
-    // Nombre de archivos de entrada y salida
-    string archivoEntrada = argv[1];
-    string archivoSalida;
-    
-    // Si se proporciona archivo de salida, usarlo; si no, generar automáticamente
-    if (argc >= 3) {
-        archivoSalida = argv[2];
-    } else {
-        archivoSalida = generarNombreSalida(archivoEntrada);
-    }
+    // Un solo grafo para todos los escenarios: limpiar() conserva su memoria
+    Grafo grafo(1);
+    grafo.usarBodega(bodega);
+    grafo.usarCacheRutas(cache);
+    grafo.setPresupuestoMejora(presupuestoMejora);
+    grafo.setPlazo(plazo);
+    grafo.setMotorRuteo(motor);
+    grafo.setHilosMST(hilosMST);
     
-    ifstream entrada(archivoEntrada);
-    if (!entrada.is_open()) {
-        cerr << "Error: No se pudo abrir el archivo " << archivoEntrada << endl;
-        return 1;
+    // Un pool para los MST de todos los escenarios en lugar de uno por MST
+    unique_ptr<PoolHilos> poolMST;
+    if (hilosMST != 1) {
+        poolMST.reset(new PoolHilos(hilosMST));
+        grafo.usarPoolMST(poolMST.get());
     }
     
-    ofstream salida(archivoSalida);
-    if (!salida.is_open()) {
-        cerr << "Error: No se pudo crear el archivo " << archivoSalida << endl;
-        return 1;
-    }
-    
-    int n; // Número de escenarios
-    entrada >> n;
-    
-    salida << n << endl;
-    
-    cout << "\n+========================================================+" << endl;
-    cout << "|   ROBOT RECOLECTOR AUTONOMO - ALGORITMO DE PRIM       |" << endl;
-    cout << "+========================================================+" << endl;
-    cout << "  Archivo de entrada: " << archivoEntrada << endl;
-    cout << "  Archivo de salida:  " << archivoSalida << endl;
-    cout << "+========================================================+\n" << endl;
-    
     for (int escenario = 0; escenario < n; escenario++) {
         int k; // Capacidad del robot
         int m; // Número de productos
         
-        entrada >> k >> m;
+        if (!entrada.leerCabecera(k, m)) {
+            cerr << "Error: " << entrada.getError() << endl;
+            return 1;
+        }
         
-        cout << "\n+--------------------------------------------------------+" << endl;
-        cout << "|  ESCENARIO " << (escenario + 1) << string(44, ' ') << "|" << endl;
-        cout << "+--------------------------------------------------------+" << endl;
-        cout << "  Capacidad del robot (k): " << k << endl;
-        cout << "  Número de productos (m): " << m << endl;
+        if (completo) {
+            cout << "\n+--------------------------------------------------------+" << endl;
+            cout << "|  ESCENARIO " << (escenario + 1) << string(44, ' ') << "|" << endl;
+            cout << "+--------------------------------------------------------+" << endl;
+            cout << "  Capacidad del robot (k): " << k << endl;
+            cout << "  Número de productos (m): " << m << endl;
+        }
         
-        // Crear grafo para este escenario
-        Grafo grafo(k);
+        // Preparar el grafo para este escenario
+        grafo.limpiar();
+        grafo.setCapacidad(k);
+        grafo.reservarProductos(m);
         
         // Leer productos
-        cout << "\n  Productos a recoger:" << endl;
+        if (completo) cout << "\n  Productos a recoger:" << endl;
         for (int i = 0; i < m; i++) {
             double x, y;
-            entrada >> x >> y;
+            if (!entrada.leerReal(x) || !entrada.leerReal(y)) {
+                cerr << "Error: " << entrada.getError() << endl;
+                return 1;
+            }
             grafo.agregarProducto(x, y);
-            cout << "    P" << (i+1) << ": (" << fixed << setprecision(2) 
-                 << x << ", " << y << ")" << endl;
+            if (completo) {
+                cout << "    P" << (i+1) << ": (" << fixed << setprecision(2) 
+                     << x << ", " << y << ")" << endl;
+            }
         }
         
+        if (!verificarBodega(bodega, grafo.getCoordenadas(), escenario + 1)) return 1;
+        
         // MOSTRAR MATRIZ DE DISTANCIAS (si hay pocos productos)
-        if (m <= 10) {
-            cout << "\n  > Calculando distancias euclidianas entre productos..." << endl;
+        if (completo && m <= 10) {
+            cout << "\n  > Calculando distancias "
+                 << (bodega != 0 ? "por los pasillos" : Metrica::nombre()) << " entre productos..." << endl;
             grafo.mostrarMatrizDistancias();
         }
         
-        // Resolver el problema usando Prim + DFS
-        cout << "  > Aplicando algoritmo de Prim..." << endl;
-        cout << "  > Construyendo MST (Arbol de Expansion Minima)..." << endl;
-        
-        // Usar la versión que retorna el MST
-        vector<Arista> mstGenerado;
-        vector<Producto> rutaOptimizada = grafo.resolverEnrutamientoConMST(mstGenerado);
+        chrono::steady_clock::time_point inicioResolucion = chrono::steady_clock::now();
         
-        // MOSTRAR MST GENERADO (si hay pocos productos)
-        if (m <= 10) {
-            grafo.mostrarMST(mstGenerado);
+        if (!completo) {
+            grafo.obtenerRuta();
+        } else if (plazo > 0) {
+            // El motor lo elige el grafo según lo que quepa en el plazo
+            cout << "  > Resolviendo con plazo de " << plazo << " ms..." << endl;
+            grafo.obtenerRuta();
+        } else if (motor == RUTEO_MST) {
+            // Resolver el problema usando Prim + DFS
+            cout << "  > Aplicando algoritmo de Prim..." << endl;
+            cout << "  > Construyendo MST (Arbol de Expansion Minima)..." << endl;
+            
+            // MST y ruta salen de la misma cache del grafo; una ruta de la
+            // cache de rutas no construyó el MST y no se construye solo
+            // para mostrarlo
+            grafo.obtenerRuta();
+            
+            if (!grafo.rutaDeCache()) {
+                // MOSTRAR MST GENERADO (si hay pocos productos)
+                if (m <= 10) {
+                    grafo.mostrarMST(grafo.obtenerMST());
+                }
+                
+                cout << "  > Recorriendo MST con DFS..." << endl;
+            }
+        } else if (motor == RUTEO_AHORROS) {
+            cout << "  > Aplicando ahorros de Clarke-Wright..." << endl;
+            grafo.obtenerRuta();
+        } else {
+            cout << "  > Aplicando barrido polar desde la base..." << endl;
+            grafo.obtenerRuta();
+        }
+        if (completo && grafo.rutaDeCache()) {
+            cout << "  > Ruta tomada de la cache (escenario ya resuelto)" << endl;
+        } else if (completo) {
+            cout << "  > Aplicando restriccion de capacidad..." << endl;
         }
         
-        cout << "  > Recorriendo MST con DFS..." << endl;
-        cout << "  > Aplicando restriccion de capacidad..." << endl;
+        double tiempoResolucion = chrono::duration<double, milli>(
+            chrono::steady_clock::now() - inicioResolucion).count();
         
-        // Calcular distancia total
-        double distanciaTotal = grafo.calcularDistanciaTotal(rutaOptimizada);
+        // Distancia total (calculada al armar la ruta)
+        const Ruta& ruta = grafo.obtenerRuta();
+        const Coordenadas& coordenadas = grafo.getCoordenadas();
+        double distanciaTotal = ruta.distanciaTotal;
+        distanciaLote += distanciaTotal;
+        
+        // Escribir resultado en archivo de salida
+        salida.escribirRuta(k, ruta, coordenadas);
+        if (metricas != 0) {
+            escribirMetricas(*metricas, escenario + 1, k, m, distanciaTotal, tiempoResolucion,
+                             grafo.getTiemposEtapas(), grafo.getContadores());
+        }
+        
+        if (!completo) continue;
         
         cout << "\n  +======================================================+" << endl;
         cout << "  |  RESULTADOS                                          |" << endl;
         cout << "  +======================================================+" << endl;
         cout << "  * Distancia total: " << fixed << setprecision(2) 
              << distanciaTotal << " metros" << endl;
-        cout << "  * Numero de viajes: " << ((m + k - 1) / k) << endl;
+        cout << "  * Numero de viajes: " << ruta.numViajes() << endl;
         cout << "  * Productos recogidos: " << m << "/" << m << endl;
+        cout << "  * Tiempo de resolucion: " << tiempoResolucion << " ms" << endl;
+        
+        if (plazo > 0 && !grafo.rutaDeCache()) {
+            const ResultadoPlazo& resultado = grafo.getResultadoPlazo();
+            const char* nombres[] = {"mst", "ahorros", "barrido"};
+            cout << "  * Primera ruta (barrido): " << resultado.distanciaInicial << " metros en "
+                 << resultado.primeraRutaMs << " ms" << endl;
+            cout << "  * Motores probados: " << resultado.motoresProbados << ", elegido: "
+                 << nombres[resultado.motor] << endl;
+            cout << "  * Plazo " << (resultado.plazoCumplido ? "cumplido" : "excedido") << endl;
+        }
+        if ((presupuestoMejora > 0 || plazo > 0) && !grafo.rutaDeCache()) {
+            const ResultadoMejora& mejora = grafo.getResultadoMejora();
+            cout << "  * Distancia antes de la mejora local: " << mejora.distanciaAntes
+                 << " metros" << endl;
+            cout << "  * Mejora local: " << mejora.movimientos << " movimientos en "
+                 << mejora.tiempoMs << " ms (" << mejora.gananciaPorMs() << " m/ms)" << endl;
+        }
         
         // DESGLOSE DE DISTANCIAS (solo si hay pocos productos)
-        if (m <= 10 && rutaOptimizada.size() > 0) {
+        if (m <= 10 && ruta.numViajes() > 0) {
             cout << "\n  DESGLOSE DE DISTANCIAS:" << endl;
             cout << "  ---------------------------------------------------------" << endl;
-            Producto posAnterior(0, 0, -1); // Inicia en base
             double distanciaAcumulada = 0.0;
             int segmento = 1;
             
-            for (size_t i = 0; i < rutaOptimizada.size(); i++) {
-                const Producto& p = rutaOptimizada[i];
-                double distSegmento = posAnterior.distanciaA(p);
-                distanciaAcumulada += distSegmento;
-                
-                cout << "    Segmento " << segmento << ": ";
-                cout << "(" << fixed << setprecision(2) << posAnterior.x << "," << posAnterior.y << ")";
-                cout << " -> (" << p.x << "," << p.y << ")";
-                cout << " = " << distSegmento << " m";
-                cout << " [Acum: " << distanciaAcumulada << " m]" << endl;
-                
-                posAnterior = p;
-                segmento++;
+            // Cada viaje: base -> productos -> base; el grafo mide cada tramo
+            // como midió la ruta (con bodega, por los pasillos)
+            for (int t = 0; t < ruta.numViajes(); t++) {
+                Producto posAnterior = ruta.base;
+                int anterior = -1;
+                for (int p = ruta.inicioViaje[t]; p <= ruta.inicioViaje[t + 1]; p++) {
+                    int indice = (p < ruta.inicioViaje[t + 1]) ? ruta.indices[p] : -1;
+                    Producto actual = (indice >= 0) ? coordenadas.producto(indice) : ruta.base;
+                    double distSegmento = grafo.distanciaTramo(anterior, indice);
+                    distanciaAcumulada += distSegmento;
+                    
+                    cout << "    Segmento " << segmento << ": ";
+                    cout << "(" << fixed << setprecision(2) << posAnterior.x << "," << posAnterior.y << ")";
+                    cout << " -> (" << actual.x << "," << actual.y << ")";
+                    cout << " = " << distSegmento << " m";
+                    cout << " [Acum: " << distanciaAcumulada << " m]" << endl;
+                    
+                    posAnterior = actual;
+                    anterior = indice;
+                    segmento++;
+                }
             }
             cout << "  ---------------------------------------------------------" << endl;
             cout << "  TOTAL: " << distanciaAcumulada << " metros\n" << endl;
         }
         
-        // Escribir resultado en archivo de salida
-        salida << k << endl;
-        salida << rutaOptimizada.size() << endl;
+        // Mostrar ruta en consola, viaje por viaje
+        cout << "\n  RUTA DETALLADA:" << endl;
+        cout << "  ---------------------------------------------------------" << endl;
         
-        for (size_t i = 0; i < rutaOptimizada.size(); i++) {
-            const Producto& producto = rutaOptimizada[i];
-            salida << fixed << setprecision(2) << producto.x << " " << producto.y << endl;
+        for (int t = 0; t < ruta.numViajes(); t++) {
+            if (t > 0) cout << endl;
+            cout << "  VIAJE " << (t + 1) << " (" << ruta.carga(t) << " productos, "
+                 << fixed << setprecision(2) << ruta.distanciaViaje[t] << " m):" << endl;
+            cout << "    +- Inicio: BASE (" << ruta.base.x << ", " << ruta.base.y << ")" << endl;
+            for (int p = ruta.inicioViaje[t]; p < ruta.inicioViaje[t + 1]; p++) {
+                int indice = ruta.indices[p];
+                cout << "    +-> Producto " << (p - ruta.inicioViaje[t] + 1) << ": ("
+                     << coordenadas.x(indice) << ", " << coordenadas.y(indice) << ")" << endl;
+            }
+            cout << "    +-> REGRESO A BASE (" << ruta.base.x << ", " << ruta.base.y << ")" << endl;
         }
         
-        // Mostrar ruta en consola
-        cout << "\n  RUTA DETALLADA:" << endl;
-        cout << "  ---------------------------------------------------------" << endl;
+        cout << "\n" << string(60, '=') << endl;
+    }
+    
+    return 0;
+}
+
+// Escenario leído completo antes de resolver (modo lote)
+struct Escenario {
+    int k;
+    Coordenadas coordenadas;
+};
+
+// Resultado de un escenario del lote
+struct ResultadoEscenario {
+    Ruta ruta;
+    double distancia;
+    double tiempoMs;
+    bool deCache;
+    TiemposEtapas etapas;
+    ContadoresGrafo contadores;
+};
+
+// Lee todos los escenarios del formato de texto
+bool leerEscenariosTexto(LectorEscenarios& entrada, int n, vector<Escenario>& escenarios) {
+    escenarios.assign(n, Escenario());
+    vector<double> intercaladas; // x0 y0 x1 y1 ...
+    for (int e = 0; e < n; e++) {
+        int m;
+        if (!entrada.leerCabecera(escenarios[e].k, m) ||
+            !entrada.leerCoordenadas(m, intercaladas)) {
+            cerr << "Error: Escenario " << (e + 1) << ", " << entrada.getError() << endl;
+            return false;
+        }
+        escenarios[e].coordenadas.reserve(m);
+        for (int i = 0; i < m; i++) {
+            escenarios[e].coordenadas.agregar(intercaladas[2 * i], intercaladas[2 * i + 1]);
+        }
+    }
+    return true;
+}
+
+// Copia los escenarios de un archivo binario
+void leerEscenariosBinario(const ArchivoBinario& entrada, vector<Escenario>& escenarios) {
+    escenarios.assign(entrada.getNumRegistros(), Escenario());
+    for (size_t e = 0; e < escenarios.size(); e++) {
+        RegistroBinario registro = entrada.registro(e);
+        escenarios[e].k = registro.k;
+        escenarios[e].coordenadas.reserve(registro.m);
+        for (size_t i = 0; i < registro.m; i++) {
+            escenarios[e].coordenadas.agregar(registro.xs[i], registro.ys[i]);
+        }
+    }
+}
+
+// Modo lote: resuelve todos los escenarios en el pool de hilos (un Grafo
+// reutilizado por hilo) dejando los resultados en el orden original
+void procesarLote(const vector<Escenario>& escenarios, vector<ResultadoEscenario>& resultados,
+                  double presupuestoMejora, double plazo, MotorRuteo motor, int numHilos,
+                  int hilosMST, const Bodega* bodega, CacheRutas* cache, Verbosidad verbosidad) {
+    int n = escenarios.size();
+    PoolHilos pool(numHilos);
+    vector<Grafo> grafos(pool.getNumHilos(), Grafo(1));
+    resultados.assign(n, ResultadoEscenario());
+    
+    if (verbosidad == VERBOSIDAD_COMPLETA) {
+        cout << "  > Resolviendo " << n << " escenarios con " << pool.getNumHilos()
+             << " hilos..." << endl;
+    }
+    chrono::steady_clock::time_point inicioLote = chrono::steady_clock::now();
+    
+    // Los trabajadores del lote ya ocupan los núcleos: cada uno usa para el
+    // MST a lo sumo núcleos / trabajadores hilos (hilosMST = 0 pide ese
+    // tope), en un pool propio que dura todo el lote en lugar de uno por MST
+    int nucleos = max(1, (int)thread::hardware_concurrency());
+    int topeMST = max(1, nucleos / pool.getNumHilos());
+    int hilosPorGrafo = (hilosMST <= 0 || hilosMST > topeMST) ? topeMST : hilosMST;
+    vector<unique_ptr<PoolHilos> > poolsMST;
+    if (hilosPorGrafo > 1) {
+        for (int h = 0; h < pool.getNumHilos(); h++) {
+            poolsMST.push_back(unique_ptr<PoolHilos>(new PoolHilos(hilosPorGrafo)));
+            grafos[h].usarPoolMST(poolsMST[h].get());
+        }
+    }
+    
+    pool.ejecutar(n, [&](int e, int hilo) {
+        chrono::steady_clock::time_point inicio = chrono::steady_clock::now();
+        const Escenario& escenario = escenarios[e];
+        Grafo& grafo = grafos[hilo];
         
-        int viaje = 1;
-        int productosEnViaje = 0;
-        bool enBase = true;
+        grafo.limpiar();
+        grafo.setCapacidad(escenario.k);
+        grafo.setPresupuestoMejora(presupuestoMejora);
+        grafo.setPlazo(plazo);
+        grafo.setMotorRuteo(motor);
+        grafo.setHilosMST(hilosPorGrafo);
+        grafo.usarBodega(bodega);
+        grafo.usarCacheRutas(cache);
+        grafo.reservarProductos(escenario.coordenadas.size());
+        for (size_t i = 0; i < escenario.coordenadas.size(); i++) {
+            grafo.agregarProducto(escenario.coordenadas.x(i), escenario.coordenadas.y(i));
+        }
+        
+        ResultadoEscenario& resultado = resultados[e];
+        resultado.ruta = grafo.obtenerRuta();
+        resultado.distancia = resultado.ruta.distanciaTotal;
+        resultado.deCache = grafo.rutaDeCache();
+        resultado.tiempoMs = chrono::duration<double, milli>(
+            chrono::steady_clock::now() - inicio).count();
+        resultado.etapas = grafo.getTiemposEtapas();
+        resultado.contadores = grafo.getContadores();
+    });
+    
+    double tiempoLote = chrono::duration<double, milli>(
+        chrono::steady_clock::now() - inicioLote).count();
+    
+    if (verbosidad != VERBOSIDAD_COMPLETA) return;
+    for (int e = 0; e < n; e++) {
+        cout << "  Escenario " << (e + 1) << ": k=" << escenarios[e].k
+             << ", productos=" << escenarios[e].coordenadas.size()
+             << ", distancia=" << fixed << setprecision(2) << resultados[e].distancia
+             << " m, tiempo=" << resultados[e].tiempoMs << " ms"
+             << (resultados[e].deCache ? " (cache)" : "") << endl;
+    }
+    cout << "  * Tiempo total del lote: " << tiempoLote << " ms" << endl;
+}
+
+// Escribe las métricas del lote en el orden de entrada
+void escribirMetricasLote(ostream& metricas, const vector<Escenario>& escenarios,
+                          const vector<ResultadoEscenario>& resultados) {
+    for (size_t e = 0; e < escenarios.size(); e++) {
+        const ResultadoEscenario& r = resultados[e];
+        escribirMetricas(metricas, e + 1, escenarios[e].k, escenarios[e].coordenadas.size(),
+                         r.distancia, r.tiempoMs, r.etapas, r.contadores);
+    }
+}
+
+// Escribe los resultados del lote como archivo binario de rutas
+bool escribirSalidaBinaria(const string& archivoSalida, const vector<Escenario>& escenarios,
+                           const vector<ResultadoEscenario>& resultados) {
+    EscritorBinario salida;
+    if (!salida.abrir(archivoSalida, BINARIO_RUTAS)) return false;
+    for (size_t e = 0; e < escenarios.size(); e++) {
+        if (!salida.agregarRuta(escenarios[e].k, escenarios[e].coordenadas, resultados[e].ruta)) {
+            return false;
+        }
+    }
+    return salida.cerrar();
+}
+
+// Modo flujo: atiende escenarios "k m x1 y1 ..." (sin la cantidad n al
+// inicio, cada uno terminado en un salto de línea) a medida que llegan por
+// entrada y responde cada uno apenas se resuelve, en el formato del archivo
+// de salida sin la n. El grafo llega configurado y conserva su memoria
+// entre pedidos. En informe deja una línea por pedido con su latencia:
+// desde que terminó de llegar hasta que la respuesta quedó escrita.
+// Devuelve false si la entrada está mal formada o la respuesta no se pudo
+// escribir.
+bool procesarFlujo(LectorEscenarios& entrada, EscritorSalida& salida, Grafo& grafo,
+                   ostream* informe, ostream* metricas, int& numEscenarios, double& distanciaTotal) {
+    while (entrada.quedanDatos()) {
+        int k, m;
+        if (!entrada.leerCabecera(k, m)) {
+            cerr << "Error: " << entrada.getError() << endl;
+            return false;
+        }
         
-        for (size_t i = 0; i < rutaOptimizada.size(); i++) {
-            const Producto& p = rutaOptimizada[i];
+        grafo.limpiar();
+        grafo.setCapacidad(k);
+        grafo.reservarProductos(m);
+        for (int i = 0; i < m; i++) {
+            double x, y;
+            if (!entrada.leerReal(x) || !entrada.leerReal(y, i == m - 1)) {
+                cerr << "Error: " << entrada.getError() << endl;
+                return false;
+            }
+            grafo.agregarProducto(x, y);
+        }
+        if (!verificarBodega(grafo.getBodega(), grafo.getCoordenadas(), numEscenarios + 1)) {
+            return false;
+        }
+        
+        chrono::steady_clock::time_point inicio = chrono::steady_clock::now();
+        const Ruta& ruta = grafo.obtenerRuta();
+        double resolucionMs = chrono::duration<double, milli>(
+            chrono::steady_clock::now() - inicio).count();
+        
+        salida.escribirRuta(k, ruta, grafo.getCoordenadas());
+        if (!salida.vaciar()) {
+            cerr << "Error: No se pudo escribir la respuesta" << endl;
+            return false;
+        }
+        double latenciaMs = chrono::duration<double, milli>(
+            chrono::steady_clock::now() - inicio).count();
+        
+        numEscenarios++;
+        distanciaTotal += ruta.distanciaTotal;
+        if (metricas != 0) {
+            escribirMetricas(*metricas, numEscenarios, k, m, ruta.distanciaTotal, latenciaMs,
+                             grafo.getTiemposEtapas(), grafo.getContadores());
+            metricas->flush();
+        }
+        if (informe != 0) {
+            *informe << "Escenario " << numEscenarios << ": k=" << k << ", productos=" << m
+                     << ", distancia=" << fixed << setprecision(2) << ruta.distanciaTotal
+                     << " m, resolucion=" << setprecision(3) << resolucionMs
+                     << " ms, latencia=" << latenciaMs << " ms"
+                     << (grafo.rutaDeCache() ? " (cache)" : "") << endl;
+        }
+    }
+    return true;
+}
+
+// Pedido de detener el servidor del socket (SIGINT o SIGTERM)
+volatile sig_atomic_t detenerServidor = 0;
+
+void pedirDetencion(int) {
+    detenerServidor = 1;
+}
+
+// Crea un socket Unix de flujo escuchando en ruta (reemplaza un socket
+// viejo con el mismo nombre); -1 si no se pudo
+int escucharSocket(const string& ruta) {
+    sockaddr_un direccion;
+    memset(&direccion, 0, sizeof(direccion));
+    direccion.sun_family = AF_UNIX;
+    if (ruta.empty() || ruta.size() >= sizeof(direccion.sun_path)) return -1;
+    memcpy(direccion.sun_path, ruta.c_str(), ruta.size());
+    
+    int servidor = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (servidor < 0) return -1;
+    unlink(ruta.c_str());
+    if (bind(servidor, (sockaddr*)&direccion, sizeof(direccion)) != 0 || listen(servidor, 16) != 0) {
+        close(servidor);
+        return -1;
+    }
+    return servidor;
+}
+
+// Proceso de larga duración: con rutaSocket vacía atiende la entrada
+// estándar hasta que se cierre y responde por la salida estándar; si no,
+// escucha en ese socket Unix y atiende las conexiones de a una, cada una
+// hasta que el cliente cierre su lado, hasta recibir SIGINT o SIGTERM
+// (termina la conexión en curso y borra el socket). Un mismo grafo (con su memoria de
+// trabajo) y un mismo pool para el MST sirven a todos los pedidos. Cada
+// respuesta se escribe al terminar su escenario, así que un cliente que
+// envía muchos pedidos seguidos debe ir leyendo mientras escribe. Con
+// archivoCache la cache de rutas se guarda al cerrarse la entrada o cada
+// conexión.
+int ejecutarFlujo(const string& rutaSocket, double presupuestoMejora, double plazo,
+                  MotorRuteo motor, int hilosMST, const Bodega* bodega, CacheRutas* cache,
+                  const string& archivoCache, Verbosidad verbosidad,
+                  const string& archivoMetricas) {
+    Grafo grafo(1);
+    grafo.usarBodega(bodega);
+    grafo.usarCacheRutas(cache);
+    grafo.setPresupuestoMejora(presupuestoMejora);
+    grafo.setPlazo(plazo);
+    grafo.setMotorRuteo(motor);
+    grafo.setHilosMST(hilosMST);
+    
+    // El pool se crea una sola vez en lugar de en cada MST grande y sirve
+    // a las rondas de Borůvka de todos los pedidos (con un solo hilo no se
+    // crea)
+    unique_ptr<PoolHilos> poolMST;
+    if (hilosMST != 1) {
+        poolMST.reset(new PoolHilos(hilosMST));
+        grafo.usarPoolMST(poolMST.get());
+    }
+    
+    ofstream archivoJSON;
+    ostream* metricas = 0;
+    if (!archivoMetricas.empty()) {
+        archivoJSON.open(archivoMetricas.c_str());
+        if (!archivoJSON.is_open()) {
+            cerr << "Error: No se pudo crear el archivo " << archivoMetricas << endl;
+            return 1;
+        }
+        metricas = &archivoJSON;
+    }
+    
+    int numEscenarios = 0;
+    double distanciaTotal = 0;
+    int codigo = 0;
+    
+    if (rutaSocket.empty()) {
+        // La salida estándar lleva las respuestas: el informe va a cerr
+        ostream* informe = (verbosidad == VERBOSIDAD_SILENCIO) ? 0 : &cerr;
+        LectorEscenarios entrada;
+        EscritorSalida salida;
+        entrada.abrirDescriptor(STDIN_FILENO);
+        if (!salida.abrirDescriptor(STDOUT_FILENO) ||
+            !procesarFlujo(entrada, salida, grafo, informe, metricas, numEscenarios, distanciaTotal)) {
+            codigo = 1;
+        }
+        salida.cerrar();
+        if (informe != 0) {
+            *informe << numEscenarios << " escenarios, distancia total " << fixed << setprecision(2)
+                     << distanciaTotal << " m" << endl;
+            if (cache != 0) mostrarCache(*informe, *cache);
+        }
+        if (!archivoCache.empty() && !cache->guardarArchivo(archivoCache)) {
+            cerr << "Error: No se pudo guardar la cache en " << archivoCache << endl;
+            codigo = 1;
+        }
+    } else {
+        int servidor = escucharSocket(rutaSocket);
+        if (servidor < 0) {
+            cerr << "Error: No se pudo escuchar en el socket " << rutaSocket << ": "
+                 << strerror(errno) << endl;
+            return 1;
+        }
+        
+        // Un cliente que se va sin leer su respuesta no debe terminar el proceso
+        signal(SIGPIPE, SIG_IGN);
+        
+        // Sin SA_RESTART, para que la señal interrumpa accept() y se vea el pedido
+        struct sigaction detencion;
+        memset(&detencion, 0, sizeof(detencion));
+        detencion.sa_handler = pedirDetencion;
+        sigemptyset(&detencion.sa_mask);
+        sigaction(SIGINT, &detencion, 0);
+        sigaction(SIGTERM, &detencion, 0);
+        
+        ostream* informe = (verbosidad == VERBOSIDAD_SILENCIO) ? 0 : &cout;
+        if (informe != 0) *informe << "Escuchando en " << rutaSocket << endl;
+        
+        while (!detenerServidor) {
+            int cliente = accept(servidor, 0, 0);
+            if (cliente < 0) {
+                if (errno == EINTR) continue;
+                cerr << "Error: accept: " << strerror(errno) << endl;
+                codigo = 1;
+                break;
+            }
             
-            if (p.x == 0 && p.y == 0) {
-                if (!enBase) {
-                    cout << "    +-> REGRESO A BASE (0.00, 0.00)" << endl;
-                    if (i < rutaOptimizada.size() - 1) {
-                        viaje++;
-                        productosEnViaje = 0;
-                        cout << "\n  VIAJE " << viaje << ":" << endl;
-                    }
-                    enBase = true;
-                }
-            } else {
-                if (enBase) {
-                    cout << "  VIAJE " << viaje << ":" << endl;
-                    cout << "    +- Inicio: BASE (0.00, 0.00)" << endl;
-                    enBase = false;
-                }
-                productosEnViaje++;
-                cout << "    +-> Producto " << productosEnViaje << ": (" 
-                     << fixed << setprecision(2) << p.x << ", " << p.y << ")" << endl;
+            // Un error en una conexión solo cierra esa conexión
+            LectorEscenarios entrada;
+            EscritorSalida salida;
+            entrada.abrirDescriptor(cliente);
+            if (salida.abrirDescriptor(cliente)) {
+                procesarFlujo(entrada, salida, grafo, informe, metricas, numEscenarios, distanciaTotal);
+                salida.cerrar();
+            }
+            close(cliente);
+            if (!archivoCache.empty() && !cache->guardarArchivo(archivoCache)) {
+                cerr << "Error: No se pudo guardar la cache en " << archivoCache << endl;
+            }
+        }
+        close(servidor);
+        unlink(rutaSocket.c_str());
+        if (informe != 0) {
+            *informe << numEscenarios << " escenarios, distancia total " << fixed << setprecision(2)
+                     << distanciaTotal << " m" << endl;
+            if (cache != 0) mostrarCache(*informe, *cache);
+        }
+    }
+    
+    return codigo;
+}
+
+int main(int argc, char* argv[]) {
+    // Separar opciones (--nombre=valor) de archivos
+    vector<string> archivos;
+    double presupuestoMejora = 0; // ms de búsqueda local por escenario
+    double plazo = 0; // ms por escenario con resolución anytime (0 = sin plazo)
+    MotorRuteo motor = RUTEO_MST;
+    bool modoLote = false;
+    int numHilos = 0; // 0 = todos los núcleos
+    int hilosMST = 1; // Borůvka secuencial
+    bool hayVerbosidad = false;
+    Verbosidad verbosidad = VERBOSIDAD_COMPLETA;
+    string archivoMetricas;
+    bool modoFlujo = false;
+    string rutaSocket;
+    string archivoBodega;
+    size_t entradasCache = 0; // 0 = sin cache de rutas
+    string archivoCache;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        string valor;
+        if (arg == "--lote") {
+            modoLote = true;
+        } else if (arg == "--flujo") {
+            modoFlujo = true;
+        } else if (leerOpcion(arg, "socket", valor)) {
+            modoFlujo = true;
+            rutaSocket = valor;
+        } else if (leerOpcion(arg, "hilos", valor)) {
+            modoLote = true;
+            numHilos = atoi(valor.c_str());
+        } else if (leerOpcion(arg, "hilos-mst", valor)) {
+            hilosMST = atoi(valor.c_str());
+        } else if (leerOpcion(arg, "mejora", valor)) {
+            presupuestoMejora = atof(valor.c_str());
+        } else if (leerOpcion(arg, "bodega", valor)) {
+            archivoBodega = valor;
+        } else if (leerOpcion(arg, "cache", valor)) {
+            if (atoi(valor.c_str()) < 1) {
+                cerr << "Error: --cache requiere al menos 1 entrada" << endl;
+                return 1;
+            }
+            entradasCache = atoi(valor.c_str());
+        } else if (leerOpcion(arg, "cache-archivo", valor)) {
+            archivoCache = valor;
+            if (entradasCache == 0) entradasCache = ENTRADAS_CACHE_DEFECTO;
+        } else if (leerOpcion(arg, "plazo", valor)) {
+            plazo = atof(valor.c_str());
+        } else if (leerOpcion(arg, "motor", valor)) {
+            if (valor == "mst") motor = RUTEO_MST;
+            else if (valor == "ahorros") motor = RUTEO_AHORROS;
+            else if (valor == "barrido") motor = RUTEO_BARRIDO;
+            else {
+                cerr << "Error: Motor desconocido " << valor << " (use mst, ahorros o barrido)" << endl;
+                return 1;
+            }
+        } else if (leerOpcion(arg, "verbosidad", valor)) {
+            hayVerbosidad = true;
+            if (valor == "silencio") verbosidad = VERBOSIDAD_SILENCIO;
+            else if (valor == "resumen") verbosidad = VERBOSIDAD_RESUMEN;
+            else if (valor == "completa") verbosidad = VERBOSIDAD_COMPLETA;
+            else {
+                cerr << "Error: Verbosidad desconocida " << valor
+                     << " (use silencio, resumen o completa)" << endl;
+                return 1;
+            }
+        } else if (leerOpcion(arg, "metricas", valor)) {
+#ifndef INSTRUMENTACION
+            cerr << "Error: --metricas requiere compilar con make INSTRUMENTACION=1" << endl;
+            return 1;
+#endif
+            archivoMetricas = valor;
+        } else if (arg.compare(0, 2, "--") == 0) {
+            cerr << "Error: Opcion desconocida " << arg << endl;
+            return 1;
+        } else {
+            archivos.push_back(arg);
+        }
+    }
+    
+    // El plano y su tabla de caminos se cargan una vez para todos los escenarios
+    const Bodega* bodega = 0;
+    if (!archivoBodega.empty()) {
+        string error;
+        bodega = Bodega::obtener(archivoBodega, error, hilosMST);
+        if (bodega == 0) {
+            cerr << "Error: " << error << endl;
+            return 1;
+        }
+    }
+    
+    // Las rutas guardadas con otro contexto o un archivo dañado se ignoran
+    // (se reemplazan al guardar)
+    unique_ptr<CacheRutas> cache;
+    if (entradasCache > 0) {
+        cache.reset(new CacheRutas(entradasCache,
+                                   contextoCache(motor, presupuestoMejora, plazo, bodega)));
+        if (!archivoCache.empty()) cache->cargar(archivoCache);
+    }
+    
+    // Proceso de larga duración: sin archivos de entrada ni de salida
+    if (modoFlujo) {
+        if (!archivos.empty() || modoLote) {
+            cerr << "Error: --flujo y --socket no usan archivos ni --lote" << endl;
+            return 1;
+        }
+        if (!hayVerbosidad) verbosidad = VERBOSIDAD_RESUMEN;
+        return ejecutarFlujo(rutaSocket, presupuestoMejora, plazo, motor, hilosMST, bodega,
+                             cache.get(), archivoCache, verbosidad, archivoMetricas);
+    }
+    
+    // Verificar argumentos
+    if (archivos.empty()) {
+        cerr << "Uso: " << argv[0] << " <archivo_entrada> [archivo_salida] [opciones]" << endl;
+        cerr << "Ejemplo: " << argv[0] << " test_input.txt" << endl;
+        cerr << "         " << argv[0] << " test_input.txt resultado.txt" << endl;
+        cerr << "Opciones:" << endl;
+        cerr << "  --mejora=MS   Mejora local de la ruta durante MS milisegundos" << endl;
+        cerr << "  --motor=M     Motor de ruteo: mst (defecto), ahorros o barrido" << endl;
+        cerr << "  --plazo=MS    Resuelve cada escenario en MS milisegundos: elige los" << endl;
+        cerr << "                motores que caben y mejora la ruta hasta el plazo" << endl;
+        cerr << "  --lote        Resuelve todos los escenarios en paralelo" << endl;
+        cerr << "  --hilos=N     Modo lote con N hilos (defecto: todos los nucleos)" << endl;
+        cerr << "  --hilos-mst=N Hilos para el MST de escenarios grandes (defecto 1;" << endl;
+        cerr << "                0 = todos los nucleos; en modo lote, a lo sumo" << endl;
+        cerr << "                nucleos / hilos del lote)" << endl;
+        cerr << "  --verbosidad=V  silencio, resumen o completa (defecto: completa," << endl;
+        cerr << "                  resumen en modo lote)" << endl;
+        cerr << "  --metricas=ARCHIVO  Metricas JSON por escenario (solo con INSTRUMENTACION;" << endl;
+        cerr << "                      defecto <entrada>_metricas.json)" << endl;
+        cerr << "  --bodega=PLANO  Distancias por los pasillos del plano (ver Bodega.h); la" << endl;
+        cerr << "                tabla de caminos se guarda en PLANO.dist" << endl;
+        cerr << "  --cache=N     Reutiliza la ruta de los escenarios repetidos (mismos k y" << endl;
+        cerr << "                productos en cualquier orden), recordando los N ultimos" << endl;
+        cerr << "  --cache-archivo=ARCHIVO  Carga la cache de ARCHIVO y la guarda al terminar" << endl;
+        cerr << "                (sin --cache recuerda " << ENTRADAS_CACHE_DEFECTO << ")" << endl;
+        cerr << "  --flujo       Atiende escenarios \"k m x y ...\" por la entrada estandar y" << endl;
+        cerr << "                responde cada uno por la salida estandar al resolverlo" << endl;
+        cerr << "                (cada escenario debe terminar en un salto de linea)" << endl;
+        cerr << "  --socket=RUTA Igual que --flujo, atendiendo conexiones en un socket Unix" << endl;
+        cerr << "                hasta recibir SIGINT o SIGTERM" << endl;
+        cerr << "Las entradas en formato binario (ver convertidor) se detectan solas," << endl;
+        cerr << "se resuelven en modo lote y producen rutas en formato binario." << endl;
+        return 1;
+    }
+    
+    // Nombre de archivos de entrada y salida
+    string archivoEntrada = archivos[0];
+    string archivoSalida;
+    
+    // Si se proporciona archivo de salida, usarlo; si no, generar automáticamente
+    if (archivos.size() >= 2) {
+        archivoSalida = archivos[1];
+    } else {
+        archivoSalida = generarNombreSalida(archivoEntrada);
+    }
+    
+    // La entrada binaria siempre se resuelve en modo lote
+    bool binario = ArchivoBinario::esBinario(archivoEntrada);
+    if (binario) modoLote = true;
+    
+    // En modo lote solo interesa el archivo de salida, salvo que se pida más
+    if (!hayVerbosidad && modoLote) verbosidad = VERBOSIDAD_RESUMEN;
+    
+    if (verbosidad == VERBOSIDAD_COMPLETA) {
+        cout << "\n+========================================================+" << endl;
+        cout << "|   ROBOT RECOLECTOR AUTONOMO - ALGORITMO DE PRIM       |" << endl;
+        cout << "+========================================================+" << endl;
+        cout << "  Archivo de entrada: " << archivoEntrada << endl;
+        cout << "  Archivo de salida:  " << archivoSalida << endl;
+        cout << "+========================================================+\n" << endl;
+    }
+    
+    // Con instrumentación, una línea JSON por escenario
+    ofstream archivoJSON;
+    ostream* metricas = 0;
+#ifdef INSTRUMENTACION
+    if (archivoMetricas.empty()) {
+        archivoMetricas = archivoEntrada.substr(0, archivoEntrada.find_last_of('.')) + "_metricas.json";
+    }
+    archivoJSON.open(archivoMetricas.c_str());
+    if (!archivoJSON.is_open()) {
+        cerr << "Error: No se pudo crear el archivo " << archivoMetricas << endl;
+        return 1;
+    }
+    metricas = &archivoJSON;
+#endif
+    
+    chrono::steady_clock::time_point inicio = chrono::steady_clock::now();
+    int numEscenarios = 0;
+    double distanciaLote = 0;
+    
+    // Entrada binaria: salida binaria de rutas
+    if (binario) {
+        ArchivoBinario entrada;
+        if (!entrada.abrir(archivoEntrada)) {
+            cerr << "Error: " << archivoEntrada << ": " << entrada.getError() << endl;
+            return 1;
+        }
+        if (entrada.getTipo() != BINARIO_ESCENARIOS) {
+            cerr << "Error: " << archivoEntrada << " no contiene escenarios" << endl;
+            return 1;
+        }
+        
+        vector<Escenario> escenarios;
+        vector<ResultadoEscenario> resultados;
+        leerEscenariosBinario(entrada, escenarios);
+        entrada.cerrar();
+        for (size_t e = 0; e < escenarios.size(); e++) {
+            if (!verificarBodega(bodega, escenarios[e].coordenadas, e + 1)) return 1;
+        }
+        procesarLote(escenarios, resultados, presupuestoMejora, plazo, motor, numHilos,
+                     hilosMST, bodega, cache.get(), verbosidad);
+        numEscenarios = escenarios.size();
+        for (size_t e = 0; e < resultados.size(); e++) distanciaLote += resultados[e].distancia;
+        if (metricas != 0) escribirMetricasLote(*metricas, escenarios, resultados);
+        
+        if (!escribirSalidaBinaria(archivoSalida, escenarios, resultados)) {
+            cerr << "Error: No se pudo escribir el archivo " << archivoSalida << endl;
+            return 1;
+        }
+    } else {
+        LectorEscenarios entrada;
+        if (!entrada.abrir(archivoEntrada)) {
+            cerr << "Error: No se pudo abrir el archivo " << archivoEntrada << endl;
+            return 1;
+        }
+        
+        EscritorSalida salida;
+        if (!salida.abrir(archivoSalida)) {
+            cerr << "Error: No se pudo crear el archivo " << archivoSalida << endl;
+            return 1;
+        }
+        
+        int n; // Número de escenarios
+        if (!entrada.leerEntero(n) || n < 0) {
+            cerr << "Error: " << (entrada.getError().empty() ? "numero de escenarios invalido"
+                                                              : entrada.getError()) << endl;
+            return 1;
+        }
+        
+        salida.escribirLinea(n);
+        numEscenarios = n;
+        
+        if (modoLote) {
+            vector<Escenario> escenarios;
+            vector<ResultadoEscenario> resultados;
+            if (!leerEscenariosTexto(entrada, n, escenarios)) return 1;
+            for (int e = 0; e < n; e++) {
+                if (!verificarBodega(bodega, escenarios[e].coordenadas, e + 1)) return 1;
+            }
+            procesarLote(escenarios, resultados, presupuestoMejora, plazo, motor, numHilos,
+                         hilosMST, bodega, cache.get(), verbosidad);
+            for (int e = 0; e < n; e++) {
+                salida.escribirRuta(escenarios[e].k, resultados[e].ruta, escenarios[e].coordenadas);
+                distanciaLote += resultados[e].distancia;
             }
+            if (metricas != 0) escribirMetricasLote(*metricas, escenarios, resultados);
+        } else {
+            int codigo = procesarSecuencial(entrada, salida, n, presupuestoMejora, plazo, motor,
+                                            hilosMST, bodega, cache.get(), verbosidad, metricas,
+                                            distanciaLote);
+            if (codigo != 0) return codigo;
         }
         
-        cout << "\n" << string(60, '=') << endl;
+        entrada.cerrar();
+        if (!salida.cerrar()) {
+            cerr << "Error: No se pudo escribir el archivo " << archivoSalida << endl;
+            return 1;
+        }
+    }
+    
+    if (!archivoCache.empty() && !cache->guardarArchivo(archivoCache)) {
+        cerr << "Error: No se pudo guardar la cache en " << archivoCache << endl;
+        return 1;
     }
     
-    entrada.close();
-    salida.close();
+    if (verbosidad == VERBOSIDAD_RESUMEN) {
+        double tiempoTotal = chrono::duration<double, milli>(
+            chrono::steady_clock::now() - inicio).count();
+        cout << numEscenarios << " escenarios, distancia total " << fixed << setprecision(2)
+             << distanciaLote << " m, " << tiempoTotal << " ms -> " << archivoSalida << endl;
+    }
+    if (verbosidad != VERBOSIDAD_SILENCIO && cache) mostrarCache(cout, *cache);
+    if (verbosidad != VERBOSIDAD_COMPLETA) return 0;
     
     cout << "\n* Proceso completado exitosamente" << endl;
     cout << "* Resultados guardados en: " << archivoSalida << endl;